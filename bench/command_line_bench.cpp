@@ -0,0 +1,248 @@
+// Compares cli::parse against the parsing it replaced: split the command line into
+// wide strings (as CommandLineToArgvW does), convert each argument to a heap
+// std::string with a two-pass UTF-8 conversion, then scan the whole vector once per
+// option, as each setup_*_from_args function did. Reports the best of several runs in
+// ns per command line, and the heap allocations per command line counted through a
+// replaced global operator new.
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "command_line.h"
+
+namespace {
+std::atomic<std::uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kRuns = 5;
+
+struct Case {
+    const char* name;
+    std::wstring_view commandLine;
+};
+
+constexpr Case kCases[] = {
+    {"empty", L"ScreenLight.exe"},
+    {"verbose", L"\"C:\\Program Files\\ScreenLight\\ScreenLight.exe\" --verbose"},
+    {"typical", L"\"C:\\Program Files\\ScreenLight\\ScreenLight.exe\" --verbose --brightness=200 --fps=60 --motion=orbit --monitor=1"},
+    {"full", L"\"C:\\Program Files\\ScreenLight\\ScreenLight.exe\" --verbose --edge-light --no-motion --brightness=128 --fps=30"
+             L" --stall-threshold=500 --battery-frame-delay=100 --footprint-interval=5000 --bounds=0,0,1920,1080"
+             L" --record=\"C:\\Users\\Some User\\capture.slrec\" --config=C:\\ScreenLight\\ScreenLight.conf --trim-after-startup"},
+};
+
+// What the old code extracted, so both paths do the same useful work.
+struct LegacyResult {
+    bool verbose = false;
+    bool edgeLight = false;
+    bool exitAfterStartup = false;
+    bool trimAfterStartup = false;
+    int brightness = -1;
+    std::string recordPath;
+    std::string configPath;
+};
+
+// Splits a command line with CommandLineToArgvW's rules into owned wide strings.
+std::vector<std::wstring> legacy_split(std::wstring_view commandLine) {
+    std::vector<std::wstring> argv;
+    std::size_t pos = 0;
+    std::wstring program;
+    if (pos < commandLine.size() && commandLine[pos] == L'"') {
+        const std::size_t close = commandLine.find(L'"', 1);
+        const std::size_t end = close == std::wstring_view::npos ? commandLine.size() : close;
+        program.assign(commandLine.substr(1, end - 1));
+        pos = end == commandLine.size() ? end : end + 1;
+    }
+    while (pos < commandLine.size() && commandLine[pos] != L' ' && commandLine[pos] != L'\t') {
+        program.push_back(commandLine[pos++]);
+    }
+    argv.push_back(std::move(program));
+    while (true) {
+        while (pos < commandLine.size() && (commandLine[pos] == L' ' || commandLine[pos] == L'\t')) ++pos;
+        if (pos == commandLine.size()) {
+            break;
+        }
+        std::wstring argument;
+        bool quoted = false;
+        std::size_t backslashes = 0;
+        for (; pos < commandLine.size(); ++pos) {
+            const wchar_t c = commandLine[pos];
+            if (c == L'\\') {
+                ++backslashes;
+                continue;
+            }
+            if (c == L'"') {
+                argument.append(backslashes / 2, L'\\');
+                if (backslashes % 2 == 1) {
+                    argument.push_back(L'"');
+                } else if (quoted && pos + 1 < commandLine.size() && commandLine[pos + 1] == L'"') {
+                    argument.push_back(L'"');
+                    ++pos;
+                } else {
+                    quoted = !quoted;
+                }
+                backslashes = 0;
+                continue;
+            }
+            if (!quoted && (c == L' ' || c == L'\t')) {
+                break;
+            }
+            argument.append(backslashes, L'\\');
+            argument.push_back(c);
+            backslashes = 0;
+        }
+        argument.append(backslashes, L'\\');
+        argv.push_back(std::move(argument));
+    }
+    return argv;
+}
+
+// Encodes one UTF-16 code unit (no surrogate pairs in the cases) as UTF-8.
+template <typename Out>
+std::size_t encode_utf8(wchar_t c, Out out) {
+    const auto u = static_cast<std::uint32_t>(c);
+    if (u < 0x80) { out(static_cast<char>(u)); return 1; }
+    if (u < 0x800) { out(static_cast<char>(0xC0 | (u >> 6))); out(static_cast<char>(0x80 | (u & 0x3F))); return 2; }
+    out(static_cast<char>(0xE0 | (u >> 12)));
+    out(static_cast<char>(0x80 | ((u >> 6) & 0x3F)));
+    out(static_cast<char>(0x80 | (u & 0x3F)));
+    return 3;
+}
+
+// The old ParseCommandLine: measure, allocate, convert, push_back, for every argument.
+std::vector<std::string> legacy_parse_command_line(std::wstring_view commandLine) {
+    const std::vector<std::wstring> argv = legacy_split(commandLine);
+    std::vector<std::string> args;
+    for (std::size_t i = 1; i < argv.size(); ++i) {
+        std::size_t size = 0;
+        for (const wchar_t c : argv[i]) size += encode_utf8(c, [](char) {});
+        std::string arg(size, '\0');
+        std::size_t at = 0;
+        for (const wchar_t c : argv[i]) encode_utf8(c, [&](char b) { arg[at++] = b; });
+        args.push_back(std::move(arg));
+    }
+    return args;
+}
+
+bool has_flag(const std::vector<std::string>& args, std::string_view flag) {
+    for (const auto& arg : args) {
+        if (arg == flag) return true;
+    }
+    return false;
+}
+
+std::string find_value(const std::vector<std::string>& args, std::string_view prefix) {
+    for (const auto& arg : args) {
+        if (arg.rfind(prefix, 0) == 0) return arg.substr(prefix.size());
+    }
+    return {};
+}
+
+LegacyResult legacy_parse(std::wstring_view commandLine) {
+    const auto args = legacy_parse_command_line(commandLine);
+    LegacyResult result;
+    result.verbose = has_flag(args, "--verbose");
+    result.edgeLight = has_flag(args, "--edge-light");
+    result.exitAfterStartup = has_flag(args, "--exit-after-startup");
+    result.trimAfterStartup = has_flag(args, "--trim-after-startup");
+    result.recordPath = find_value(args, "--record=");
+    result.configPath = find_value(args, "--config=");
+    const std::string brightness = find_value(args, "--brightness=");
+    std::from_chars(brightness.data(), brightness.data() + brightness.size(), result.brightness);
+    find_value(args, "--stall-threshold=");
+    find_value(args, "--battery-frame-delay=");
+    find_value(args, "--footprint-interval=");
+    find_value(args, "--motion=");
+    find_value(args, "--bounds=");
+    return result;
+}
+
+struct Measurement {
+    double ns;
+    double allocations;
+};
+
+// Runs fn(commandLine) iterations times per run and returns the fastest run.
+template <typename Fn>
+Measurement measure(std::wstring_view commandLine, std::uint64_t iterations, Fn&& fn, std::uint64_t& checksum) {
+    Measurement best{0.0, 0.0};
+    for (int run = 0; run < kRuns; ++run) {
+        const std::uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            checksum += fn(commandLine);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(iterations);
+        const double allocations = static_cast<double>(g_allocations.load(std::memory_order_relaxed) - allocationsBefore)
+            / static_cast<double>(iterations);
+        if (run == 0 || ns < best.ns) {
+            best = {ns, allocations};
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t iterations = 1'000'000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view prefix = "--iterations=";
+        const auto [ptr, ec] = arg.starts_with(prefix)
+            ? std::from_chars(arg.data() + prefix.size(), arg.data() + arg.size(), iterations)
+            : std::from_chars_result{arg.data(), std::errc::invalid_argument};
+        if (ec != std::errc() || ptr != arg.data() + arg.size() || iterations == 0) {
+            std::fprintf(stderr, "Usage: ScreenLightCommandLineBench [--iterations=N]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::printf("iterations=%llu runs=%d\n", static_cast<unsigned long long>(iterations), kRuns);
+    std::printf("%-8s %12s %12s %8s %14s %14s\n", "case", "parse_ns", "legacy_ns", "ratio", "parse_allocs", "legacy_allocs");
+    std::uint64_t checksum = 0;
+    for (const Case& c : kCases) {
+        const Measurement parsed = measure(c.commandLine, iterations, [](std::wstring_view line) {
+            cli::Options options;
+            cli::parse(line, options);
+            return static_cast<std::uint64_t>(options.verbose) + options.brightness.value_or(0) + options.recordPath.size();
+        }, checksum);
+        const Measurement legacy = measure(c.commandLine, iterations, [](std::wstring_view line) {
+            const LegacyResult result = legacy_parse(line);
+            return static_cast<std::uint64_t>(result.verbose) + static_cast<std::uint64_t>(std::max(result.brightness, 0))
+                + result.recordPath.size();
+        }, checksum);
+        std::printf("%-8s %12.1f %12.1f %7.2fx %14.1f %14.1f\n", c.name, parsed.ns, legacy.ns,
+                    parsed.ns > 0.0 ? legacy.ns / parsed.ns : 0.0, parsed.allocations, legacy.allocations);
+    }
+    std::printf("checksum=%llu\n", static_cast<unsigned long long>(checksum));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+// Times governor::take_sample, the call the application makes every governor interval,
+// then runs the governor on a simulated session: a cheap tick, a phase where each tick
+// costs 100 times more (as SetCursorPos can over a remote session), a saturated system,
+// and a cheap tick again. Prints the governed delay, tick rate and usage per phase.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "config.h"
+#include "cpu_governor.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kRuns = 5;
+
+double sample_ns(int samples) {
+    double best = 0.0;
+    for (int run = 0; run < kRuns; ++run) {
+        std::uint64_t sink = 0;
+        const auto start = Clock::now();
+        for (int i = 0; i < samples; ++i) {
+            sink += static_cast<std::uint64_t>(governor::take_sample().processCpu.count());
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / samples;
+        if (run == 0 || ns < best) best = ns;
+        if (sink == 1) std::printf(" ");
+    }
+    return best;
+}
+
+struct Phase {
+    const char* name;
+    int seconds;
+    double tickCostUs;  // CPU per motion tick.
+    int systemBusyPercent;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int samples = 20000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view prefix = "--samples=";
+        const auto [ptr, ec] = arg.starts_with(prefix)
+            ? std::from_chars(arg.data() + prefix.size(), arg.data() + arg.size(), samples)
+            : std::from_chars_result{arg.data(), std::errc::invalid_argument};
+        if (ec != std::errc() || ptr != arg.data() + arg.size() || samples <= 0) {
+            std::fprintf(stderr, "Usage: ScreenLightCpuGovernorBench [--samples=N]\n");
+            return EXIT_FAILURE;
+        }
+    }
+    std::printf("take_sample_ns=%.0f (best of %d runs of %d)\n", sample_ns(samples), kRuns, samples);
+
+    // Simulated time: per-tick cost plus a small fixed cost for everything else.
+    constexpr double kBackgroundPermille = 0.5;
+    constexpr Phase kPhases[] = {
+        {"cheap", 60, 5.0, 20},
+        {"costly", 120, 500.0, 20},
+        {"busy", 60, 5.0, 95},
+        {"cheap", 120, 5.0, 20},
+    };
+    const governor::Budget budget;
+    governor::Governor governor(budget);
+    governor::CpuSample sample;
+    sample.at = Clock::time_point{};
+    governor.update(sample, config::kFrameDelayMs);
+
+    std::printf("budget=%d/1000 base_delay=%ums interval=%ums\n", budget.permille, config::kFrameDelayMs,
+                config::kGovernorIntervalMs);
+    std::printf("%-8s %8s %10s %10s %12s %10s\n", "phase", "seconds", "delay_ms", "rate_hz", "usage_1000", "throttles");
+    for (const Phase& phase : kPhases) {
+        const int intervals = phase.seconds * 1000 / static_cast<int>(config::kGovernorIntervalMs);
+        for (int i = 0; i < intervals; ++i) {
+            const double ticks = static_cast<double>(config::kGovernorIntervalMs) / governor.frame_delay_ms();
+            const double cpuUs = ticks * phase.tickCostUs + kBackgroundPermille * config::kGovernorIntervalMs;
+            sample.at += std::chrono::milliseconds(config::kGovernorIntervalMs);
+            sample.processCpu += std::chrono::microseconds(static_cast<std::int64_t>(cpuUs));
+            sample.systemTotal += 100 * config::kGovernorIntervalMs;
+            sample.systemBusy += static_cast<std::uint64_t>(phase.systemBusyPercent) * config::kGovernorIntervalMs;
+            governor.update(sample, config::kFrameDelayMs);
+        }
+        std::printf("%-8s %8d %10u %10.1f %12d %10llu\n", phase.name, phase.seconds, governor.frame_delay_ms(),
+                    1000.0 / governor.frame_delay_ms(), governor.usage_permille(),
+                    static_cast<unsigned long long>(governor.throttle_count()));
+    }
+    return EXIT_SUCCESS;
+}
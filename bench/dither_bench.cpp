@@ -0,0 +1,104 @@
+// Times one full-surface fill of the dithered light at 1080p and 4K: the tile fill the
+// application uses, a per-pixel threshold loop doing the same job, and a plain solid
+// fill as the floor. Reports the best of several runs in ms per frame, and the tile
+// build, which happens once per level change, in ns.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+#include "color_temperature.h"
+#include "dither.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kRuns = 5;
+
+struct Resolution {
+    const char* name;
+    int width;
+    int height;
+};
+
+constexpr Resolution kResolutions[] = {
+    {"1080p", 1920, 1080},
+    {"4K", 3840, 2160},
+};
+
+// Runs fn() frames times per run and returns the fastest run's ms per frame.
+template <typename Fn>
+double measure_ms(int frames, Fn&& fn) {
+    double best = 0.0;
+    for (int run = 0; run < kRuns; ++run) {
+        const auto start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            fn(frame);
+        }
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+        if (run == 0 || ms < best) {
+            best = ms;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = 50;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view prefix = "--frames=";
+        const auto [ptr, ec] = arg.starts_with(prefix)
+            ? std::from_chars(arg.data() + prefix.size(), arg.data() + arg.size(), frames)
+            : std::from_chars_result{arg.data(), std::errc::invalid_argument};
+        if (ec != std::errc() || ptr != arg.data() + arg.size() || frames <= 0) {
+            std::fprintf(stderr, "Usage: ScreenLightDitherBench [--frames=N]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A dark, warm light between two levels, where banding shows most.
+    const std::uint32_t base = dither::pack(color::light_color(12, 3200));
+    const std::uint32_t next = dither::pack(color::light_color(13, 3200));
+
+    std::uint64_t checksum = 0;
+    constexpr int kTileBuilds = 1'000'000;
+    const auto tileStart = Clock::now();
+    for (int i = 0; i < kTileBuilds; ++i) {
+        checksum += dither::make_tile(base + static_cast<std::uint32_t>(i & 1), next, i % dither::kSteps).rows[1][2];
+    }
+    const double tileNs = std::chrono::duration<double, std::nano>(Clock::now() - tileStart).count() / kTileBuilds;
+
+    std::printf("frames=%d runs=%d tile_build_ns=%.1f\n", frames, kRuns, tileNs);
+    std::printf("%-6s %10s %10s %13s %8s %10s\n", "size", "solid_ms", "tile_ms", "per_pixel_ms", "ratio", "tile_GB/s");
+    for (const Resolution& r : kResolutions) {
+        std::vector<std::uint32_t> surface(static_cast<std::size_t>(r.width) * static_cast<std::size_t>(r.height));
+        // Fractions vary per frame so no fill can be skipped as a repeat of the last.
+        const double solid = measure_ms(frames, [&](int frame) {
+            std::fill(surface.begin(), surface.end(), base + static_cast<std::uint32_t>(frame & 1));
+            checksum += surface[static_cast<std::size_t>(frame) % surface.size()];
+        });
+        const double tiled = measure_ms(frames, [&](int frame) {
+            const dither::Tile tile = dither::make_tile(base, next, 1 + frame % (dither::kSteps - 1));
+            dither::fill(surface.data(), r.width, r.height, r.width, tile);
+            checksum += surface[static_cast<std::size_t>(frame) % surface.size()];
+        });
+        const double perPixel = measure_ms(frames, [&](int frame) {
+            dither::fill_per_pixel(surface.data(), r.width, r.height, r.width, base, next, 1 + frame % (dither::kSteps - 1));
+            checksum += surface[static_cast<std::size_t>(frame) % surface.size()];
+        });
+        const double gigabytes = static_cast<double>(surface.size() * sizeof(std::uint32_t)) / 1e9;
+        std::printf("%-6s %10.3f %10.3f %13.3f %7.2fx %10.2f\n", r.name, solid, tiled, perPixel,
+                    tiled > 0.0 ? perPixel / tiled : 0.0, tiled > 0.0 ? gigabytes / (tiled / 1000.0) : 0.0);
+    }
+    std::printf("checksum=%llu\n", static_cast<unsigned long long>(checksum));
+    return EXIT_SUCCESS;
+}
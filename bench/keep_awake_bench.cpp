@@ -0,0 +1,193 @@
+// Runs each keep-awake strategy on the real desktop for a fixed period and reports its
+// cost and whether it reset the system's idle detection (GetLastInputInfo):
+//
+//   cursor-bounce    The motion thread's default SetCursorPos bounce, every frame.
+//   idle-nudge       The motion thread's nudge policy: it wakes only for a move and its
+//                    return, once every IdleNudgeMotion::kNudgeInterval frames.
+//   sendinput-zero   A zero-distance SendInput mouse move at the nudge cadence.
+//   execution-state  SetThreadExecutionState(ES_CONTINUOUS | ES_SYSTEM_REQUIRED |
+//                    ES_DISPLAY_REQUIRED), as the application holds it.
+//   power-request    PowerCreateRequest with display and system requests set.
+//
+// CPU is the process's user plus kernel time over the period; the bench thread only
+// waits meanwhile. Wakeups are the strategy's own timer wakeups, counted. Windows has
+// no per-process system call counter, so the syscall column is an estimate: the
+// kernel-entering calls each strategy is expected to make (timer arms, waits, cursor
+// or input injection, power calls), assuming one kernel entry per call. Leave the
+// mouse and keyboard alone while it runs: real input also resets idle detection.
+//
+// Windows only. Usage: ScreenLightKeepAwakeBench [--seconds=N] [--only=NAME]
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "config.h"
+#include "motion_thread.h"
+
+namespace {
+
+// The cadence of the nudge policy's moves, used by the strategies that need no per-frame tick.
+constexpr unsigned int kNudgePeriodMs = config::kFrameDelayMs * IdleNudgeMotion::kNudgeInterval;
+
+struct Cost {
+    std::uint64_t wakeups = 0;
+    std::uint64_t estimatedSyscalls = 0;
+};
+
+std::chrono::microseconds process_cpu() {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        return std::chrono::microseconds(0);
+    }
+    const auto ticks = [](const FILETIME& t) { return (static_cast<std::uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+    // FILETIME counts 100 ns units.
+    return std::chrono::microseconds((ticks(kernel) + ticks(user)) / 10);
+}
+
+DWORD last_input_tick() {
+    LASTINPUTINFO info = {};
+    info.cbSize = sizeof(info);
+    return GetLastInputInfo(&info) ? info.dwTime : 0;
+}
+
+// The motion thread as the application runs it, with the given policy.
+Cost run_motion(MotionKind kind, DWORD periodMs) {
+    MotionThread motion;
+    motion.set_policies(kind, BoundsKind::PrimaryScreen);
+    if (!motion.start(config::kFrameDelayMs, config::kVelocity, {config::kInitialX, config::kInitialY})) {
+        return {};
+    }
+    Sleep(periodMs);
+    motion.stop();
+    // Each wakeup follows a timer arm and a wait; moves are SetCursorPos calls.
+    return {motion.tick_count(), motion.tick_count() * 2 + motion.move_count()};
+}
+
+Cost run_send_input(DWORD periodMs) {
+    const HANDLE timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_MODIFY_STATE | SYNCHRONIZE);
+    if (!timer) {
+        return {};
+    }
+    LARGE_INTEGER due;
+    due.QuadPart = -static_cast<LONGLONG>(kNudgePeriodMs) * 10'000;
+    SetWaitableTimer(timer, &due, static_cast<LONG>(kNudgePeriodMs), NULL, NULL, FALSE);
+    Cost cost{0, 1};
+    INPUT input = {};
+    input.type = INPUT_MOUSE;
+    input.mi.dwFlags = MOUSEEVENTF_MOVE; // Relative, zero distance: the cursor stays put.
+    const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(periodMs);
+    while (std::chrono::steady_clock::now() < end) {
+        WaitForSingleObject(timer, INFINITE);
+        SendInput(1, &input, sizeof(input));
+        ++cost.wakeups;
+        cost.estimatedSyscalls += 2;
+    }
+    CloseHandle(timer);
+    return cost;
+}
+
+Cost run_execution_state(DWORD periodMs) {
+    SetThreadExecutionState(ES_CONTINUOUS | ES_SYSTEM_REQUIRED | ES_DISPLAY_REQUIRED);
+    Sleep(periodMs);
+    SetThreadExecutionState(ES_CONTINUOUS);
+    return {0, 2};
+}
+
+Cost run_power_request(DWORD periodMs) {
+    REASON_CONTEXT reason = {};
+    reason.Version = POWER_REQUEST_CONTEXT_VERSION;
+    reason.Flags = POWER_REQUEST_CONTEXT_SIMPLE_STRING;
+    wchar_t text[] = L"ScreenLight keep-awake benchmark";
+    reason.Reason.SimpleReasonString = text;
+    const HANDLE request = PowerCreateRequest(&reason);
+    if (request == INVALID_HANDLE_VALUE) {
+        return {};
+    }
+    PowerSetRequest(request, PowerRequestDisplayRequired);
+    PowerSetRequest(request, PowerRequestSystemRequired);
+    Sleep(periodMs);
+    PowerClearRequest(request, PowerRequestSystemRequired);
+    PowerClearRequest(request, PowerRequestDisplayRequired);
+    CloseHandle(request);
+    return {0, 6};
+}
+
+struct Strategy {
+    std::string_view name;
+    Cost (*run)(DWORD periodMs);
+};
+
+constexpr Strategy kStrategies[] = {
+    {"cursor-bounce", [](DWORD periodMs) { return run_motion(MotionKind::Bounce, periodMs); }},
+    {"idle-nudge", [](DWORD periodMs) { return run_motion(MotionKind::IdleNudge, periodMs); }},
+    {"sendinput-zero", run_send_input},
+    {"execution-state", run_execution_state},
+    {"power-request", run_power_request},
+};
+
+// The real version: GetVersionEx reports whatever the manifest claims.
+void print_os_version() {
+    using RtlGetVersion = LONG(WINAPI*)(OSVERSIONINFOW*);
+    OSVERSIONINFOW version = {};
+    version.dwOSVersionInfoSize = sizeof(version);
+    const auto get = reinterpret_cast<RtlGetVersion>(
+        reinterpret_cast<void*>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "RtlGetVersion")));
+    if (get && get(&version) == 0) {
+        std::printf("os=%lu.%lu.%lu\n", version.dwMajorVersion, version.dwMinorVersion, version.dwBuildNumber);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int seconds = 60;
+    std::string_view only;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view secondsPrefix = "--seconds=";
+        constexpr std::string_view onlyPrefix = "--only=";
+        bool ok = false;
+        if (arg.starts_with(secondsPrefix)) {
+            const auto [ptr, ec] = std::from_chars(arg.data() + secondsPrefix.size(), arg.data() + arg.size(), seconds);
+            ok = ec == std::errc() && ptr == arg.data() + arg.size() && seconds > 0;
+        } else if (arg.starts_with(onlyPrefix)) {
+            only = arg.substr(onlyPrefix.size());
+            ok = false;
+            for (const Strategy& strategy : kStrategies) ok = ok || strategy.name == only;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "Usage: ScreenLightKeepAwakeBench [--seconds=N] [--only=NAME]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    print_os_version();
+    std::printf("period=%ds frame_delay=%ums nudge_period=%ums\n", seconds, config::kFrameDelayMs, kNudgePeriodMs);
+    std::printf("%-16s %12s %12s %16s %11s %13s\n", "strategy", "cpu_ms_h", "wakeups_h", "est_syscalls_h", "idle_reset",
+                "idle_at_end_ms");
+    const double perHour = 3600.0 / seconds;
+    for (const Strategy& strategy : kStrategies) {
+        if (!only.empty() && strategy.name != only) {
+            continue;
+        }
+        // Let input from the previous strategy age, so each starts from a quiet system.
+        Sleep(1000);
+        const DWORD inputBefore = last_input_tick();
+        const auto cpuBefore = process_cpu();
+        const Cost cost = strategy.run(static_cast<DWORD>(seconds) * 1000);
+        const auto cpu = process_cpu() - cpuBefore;
+        const DWORD inputAfter = last_input_tick();
+        std::printf("%-16.*s %12.1f %12.0f %16.0f %11s %13lu\n", static_cast<int>(strategy.name.size()),
+                    strategy.name.data(), std::chrono::duration<double, std::milli>(cpu).count() * perHour,
+                    static_cast<double>(cost.wakeups) * perHour, static_cast<double>(cost.estimatedSyscalls) * perHour,
+                    inputAfter != inputBefore ? "yes" : "no", GetTickCount() - inputAfter);
+    }
+    return EXIT_SUCCESS;
+}
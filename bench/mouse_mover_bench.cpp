@@ -0,0 +1,136 @@
+// Compares the policy-specialized MouseMover against a type-erased equivalent that
+// picks its policies at runtime and calls update() through a virtual interface, as a
+// non-template mover would. Each row drives one motion/bounds combination for the
+// same number of updates and reports the best of several runs in ns per update.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+
+#include "mouse_mover.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kRuns = 5;
+constexpr ScreenRect kArea{0, 0, 1920, 1080};
+
+// Hides a value from the optimizer, as if it had been read from the command line.
+template <typename T>
+T opaque(T value) {
+    volatile T copy = value;
+    return copy;
+}
+
+// The runtime-polymorphic mover: one virtual call per update, policies fixed at construction.
+class AnyMouseMover {
+public:
+    virtual ~AnyMouseMover() = default;
+    virtual CursorPoint update() = 0;
+};
+
+template <typename Mover>
+class ErasedMouseMover final : public AnyMouseMover {
+public:
+    explicit ErasedMouseMover(const Mover& mover) : m_mover(mover) {}
+    CursorPoint update() override { return m_mover.update(); }
+
+private:
+    Mover m_mover;
+};
+
+template <typename Motion, typename Bounds>
+BasicMouseMover<Motion, Bounds> make_mover() {
+    return BasicMouseMover<Motion, Bounds>(Bounds(kArea));
+}
+
+std::unique_ptr<AnyMouseMover> make_any_mover(MotionKind motion, BoundsKind bounds) {
+    return with_motion_policy(motion, [&](auto m) {
+        return with_bounds_policy(bounds, [&](auto b) -> std::unique_ptr<AnyMouseMover> {
+            using Mover = BasicMouseMover<typename decltype(m)::type, typename decltype(b)::type>;
+            return std::make_unique<ErasedMouseMover<Mover>>(make_mover<typename decltype(m)::type, typename decltype(b)::type>());
+        });
+    });
+}
+
+// Runs fn(updates) kRuns times and returns the fastest run in ns per update. The
+// positions are folded into a checksum so the updates cannot be optimized away.
+template <typename Fn>
+double best_ns_per_update(std::uint64_t updates, Fn&& fn, std::uint64_t& checksum) {
+    double best = 0.0;
+    for (int run = 0; run < kRuns; ++run) {
+        const auto start = Clock::now();
+        checksum += fn(updates);
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(updates);
+        best = run == 0 ? ns : std::min(best, ns);
+    }
+    return best;
+}
+
+template <typename Motion, typename Bounds>
+void compare(const char* motionName, MotionKind motion, const char* boundsName, BoundsKind bounds,
+             std::uint64_t updates, std::uint64_t& checksum) {
+    const double specialized = best_ns_per_update(updates, [](std::uint64_t n) {
+        auto mover = make_mover<Motion, Bounds>();
+        std::uint64_t sum = 0;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            const CursorPoint point = mover.update();
+            sum += static_cast<std::uint32_t>(point.x) ^ static_cast<std::uint32_t>(point.y);
+        }
+        return sum;
+    }, checksum);
+    const double erased = best_ns_per_update(updates, [&](std::uint64_t n) {
+        const auto mover = make_any_mover(opaque(motion), opaque(bounds));
+        std::uint64_t sum = 0;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            const CursorPoint point = mover->update();
+            sum += static_cast<std::uint32_t>(point.x) ^ static_cast<std::uint32_t>(point.y);
+        }
+        return sum;
+    }, checksum);
+    std::printf("%-8s %-8s %14.3f %14.3f %8.2fx\n", motionName, boundsName, specialized, erased,
+                specialized > 0.0 ? erased / specialized : 0.0);
+}
+
+template <typename Motion>
+void compare_bounds(const char* motionName, MotionKind motion, std::uint64_t updates, std::uint64_t& checksum) {
+    compare<Motion, PrimaryScreenBounds>(motionName, motion, "primary", BoundsKind::PrimaryScreen, updates, checksum);
+    compare<Motion, VirtualDesktopBounds>(motionName, motion, "virtual", BoundsKind::VirtualDesktop, updates, checksum);
+    compare<Motion, SubRectBounds>(motionName, motion, "subrect", BoundsKind::SubRect, updates, checksum);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t updates = 20'000'000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view prefix = "--updates=";
+        if (arg.starts_with(prefix)) {
+            const auto [ptr, ec] = std::from_chars(arg.data() + prefix.size(), arg.data() + arg.size(), updates);
+            if (ec != std::errc() || ptr != arg.data() + arg.size() || updates == 0) {
+                std::fprintf(stderr, "Usage: ScreenLightMoverBench [--updates=N]\n");
+                return EXIT_FAILURE;
+            }
+        } else {
+            std::fprintf(stderr, "Usage: ScreenLightMoverBench [--updates=N]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::printf("updates=%llu runs=%d area=%dx%d\n", static_cast<unsigned long long>(updates), kRuns, kArea.right, kArea.bottom);
+    std::printf("%-8s %-8s %14s %14s %9s\n", "motion", "bounds", "specialized_ns", "erased_ns", "ratio");
+    std::uint64_t checksum = 0;
+    compare_bounds<BounceMotion>("bounce", MotionKind::Bounce, updates, checksum);
+    compare_bounds<JiggleMotion>("jiggle", MotionKind::Jiggle, updates, checksum);
+    compare_bounds<OrbitMotion>("orbit", MotionKind::Orbit, updates, checksum);
+    compare_bounds<IdleNudgeMotion>("nudge", MotionKind::IdleNudge, updates, checksum);
+    std::printf("checksum=%llu\n", static_cast<unsigned long long>(checksum));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+// Times loading a schedule file with many keyframes (parse, sort check and table
+// build) and the lazy evaluation the application does at each wakeup, then counts the
+// wakeups a day of a typical evening schedule and of the large one takes, against
+// polling once a second.
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "schedule.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kRuns = 20;
+
+// Keyframes spread over the day, alternating between a bright cool and a dim warm light.
+std::string make_file(int keyframes) {
+    std::string text;
+    char line[64];
+    for (int i = 0; i < keyframes; ++i) {
+        const int seconds = static_cast<int>(static_cast<long long>(i) * 86400 / keyframes);
+        std::snprintf(line, sizeof(line), "%02d:%02d:%02d %d %d\n", seconds / 3600, seconds / 60 % 60, seconds % 60,
+                      i % 2 == 0 ? 240 : 60, i % 2 == 0 ? 6500 : 2700);
+        text += line;
+    }
+    return text;
+}
+
+int wakeups_per_day(const schedule::Schedule& schedule) {
+    int wakeups = 0;
+    long long t = 0;
+    while (t < schedule::kDayMs) {
+        const std::optional<int> delay = schedule.until_change(static_cast<int>(t));
+        if (!delay) break;
+        t += *delay;
+        ++wakeups;
+    }
+    return wakeups;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int keyframes = 5000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view prefix = "--keyframes=";
+        const auto [ptr, ec] = arg.starts_with(prefix)
+            ? std::from_chars(arg.data() + prefix.size(), arg.data() + arg.size(), keyframes)
+            : std::from_chars_result{arg.data(), std::errc::invalid_argument};
+        if (ec != std::errc() || ptr != arg.data() + arg.size() || keyframes <= 0 || keyframes > 86400) {
+            std::fprintf(stderr, "Usage: ScreenLightScheduleBench [--keyframes=N]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    const std::string text = make_file(keyframes);
+    schedule::Schedule large;
+    std::string error;
+    double bestLoadUs = 0.0;
+    for (int run = 0; run < kRuns; ++run) {
+        schedule::Schedule loaded;
+        const auto start = Clock::now();
+        if (!schedule::parse(text, loaded, error)) {
+            std::fprintf(stderr, "Could not parse the generated schedule: %s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        if (run == 0 || us < bestLoadUs) bestLoadUs = us;
+        large = std::move(loaded);
+    }
+
+    // One wakeup's work: the output now and the time to the next change.
+    constexpr int kEvaluations = 1'000'000;
+    long long sink = 0;
+    const auto start = Clock::now();
+    for (int i = 0; i < kEvaluations; ++i) {
+        const int dayMs = static_cast<int>(static_cast<long long>(i) * 86'399 % schedule::kDayMs);
+        sink += large.at(dayMs).grayLevel + large.until_change(dayMs).value_or(0);
+    }
+    const double evaluateNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kEvaluations;
+
+    schedule::Schedule evening;
+    if (!schedule::parse("07:00 255 6500\n17:00 255 6500\n21:00 90 2700\n23:30 40 2200\n06:00 40 2200\n", evening, error)) {
+        std::fprintf(stderr, "Could not parse the evening schedule: %s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::printf("keyframes=%d file_bytes=%zu runs=%d\n", keyframes, text.size(), kRuns);
+    std::printf("load_us=%.1f (%.1f ns per keyframe)\n", bestLoadUs, bestLoadUs * 1000.0 / keyframes);
+    std::printf("evaluate_ns=%.1f (at + until_change) sink=%lld\n", evaluateNs, sink % 10);
+    std::printf("%-10s %12s %12s\n", "schedule", "wakeups/day", "polling_1hz");
+    std::printf("%-10s %12d %12d\n", "evening", wakeups_per_day(evening), 86400);
+    std::printf("%-10s %12d %12d\n", "large", wakeups_per_day(large), 86400);
+    return EXIT_SUCCESS;
+}
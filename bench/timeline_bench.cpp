@@ -0,0 +1,167 @@
+// Measures the timeline scheduler on simulated time, so results do not depend on the
+// host's timer resolution. Two parts:
+//
+// - resume: N tasks that each wait for the next frame, in a loop. Reports ns per task
+//   resume (heap pop, coroutine resume, heap push) and timer arms per frame, which stay
+//   at one however many tasks share the frame.
+// - session: a simulated session with the application's periodic work: footprint
+//   sampling, a key press every 700 ms restarting the HUD's hold and fade, and an
+//   occasional short per-frame animation. Reports wakeups, resumes and timer arms, and
+//   checks the timer is disarmed once the last task ends.
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "config.h"
+#include "timeline.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+using timeline::Clock;
+
+constexpr int kRuns = 5;
+constexpr std::chrono::milliseconds kFrame{config::kFrameDelayMs};
+
+// Counts arm and disarm calls instead of touching a platform timer.
+class CountingTimer final : public timeline::Timer {
+public:
+    void arm(std::chrono::milliseconds) override { ++arms; }
+    void disarm() override { ++disarms; }
+
+    std::uint64_t arms = 0;
+    std::uint64_t disarms = 0;
+};
+
+timeline::Task every_frame(timeline::Scheduler& scheduler, std::uint64_t& work) {
+    while (true) {
+        co_await scheduler.next_frame();
+        ++work;
+    }
+}
+
+timeline::Task periodic(timeline::Scheduler& scheduler, Clock::duration period, std::uint64_t& work) {
+    while (true) {
+        co_await scheduler.after(period);
+        ++work;
+    }
+}
+
+// The HUD's shape: a hold, then a few fade steps, then done.
+timeline::Task hold_and_fade(timeline::Scheduler& scheduler, std::uint64_t& work) {
+    co_await scheduler.after(1500ms);
+    for (int step = 1; step < 8; ++step) {
+        ++work;
+        co_await scheduler.after(50ms);
+    }
+    ++work;
+}
+
+// A short animation that runs for a number of frames.
+timeline::Task animate(timeline::Scheduler& scheduler, int frames, std::uint64_t& work) {
+    for (int frame = 0; frame < frames; ++frame) {
+        co_await scheduler.next_frame();
+        ++work;
+    }
+}
+
+// Key presses: each restarts the HUD, and every fourth also starts a short animation.
+timeline::Task keys(timeline::Scheduler& scheduler, int presses, timeline::TaskId& hud, std::uint64_t& work) {
+    for (int press = 0; press < presses; ++press) {
+        co_await scheduler.after(700ms);
+        scheduler.cancel(hud);
+        hud = scheduler.spawn(hold_and_fade(scheduler, work));
+        if (press % 4 == 0) {
+            scheduler.spawn(animate(scheduler, 20, work));
+        }
+    }
+}
+
+// Fires the timer at each armed deadline, as WM_TIMER would, until nothing is armed or
+// the end time is reached. Returns the number of wakeups.
+std::uint64_t drive(timeline::Scheduler& scheduler, Clock::time_point end) {
+    std::uint64_t wakeups = 0;
+    while (const auto deadline = scheduler.armed_deadline()) {
+        if (*deadline > end) {
+            break;
+        }
+        scheduler.run_due(*deadline);
+        ++wakeups;
+    }
+    return wakeups;
+}
+
+void bench_resume(int frames) {
+    std::printf("%-6s %14s %14s\n", "tasks", "ns_per_resume", "arms_per_frame");
+    for (const int tasks : {1, 16, 256, 4096}) {
+        double best = 0.0;
+        double armsPerFrame = 0.0;
+        for (int run = 0; run < kRuns; ++run) {
+            CountingTimer timer;
+            timeline::Scheduler scheduler(timer, kFrame);
+            std::uint64_t work = 0;
+            for (int i = 0; i < tasks; ++i) {
+                scheduler.spawn(every_frame(scheduler, work));
+            }
+            Clock::time_point now = *scheduler.armed_deadline();
+            const std::uint64_t armsBefore = timer.arms;
+            const auto start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame) {
+                scheduler.run_due(now);
+                now += kFrame;
+            }
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count()
+                / static_cast<double>(work);
+            if (run == 0 || ns < best) {
+                best = ns;
+            }
+            armsPerFrame = static_cast<double>(timer.arms - armsBefore) / frames;
+            scheduler.clear();
+        }
+        std::printf("%-6d %14.1f %14.2f\n", tasks, best, armsPerFrame);
+    }
+}
+
+void bench_session(int presses) {
+    CountingTimer timer;
+    timeline::Scheduler scheduler(timer, kFrame);
+    std::uint64_t work = 0;
+    timeline::TaskId hud = 0;
+    const timeline::TaskId footprint = scheduler.spawn(periodic(scheduler, 10s, work));
+    scheduler.spawn(keys(scheduler, presses, hud, work));
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + presses * 700ms + 3s;
+    const std::uint64_t wakeups = drive(scheduler, end);
+    // The window closing: only footprint sampling is left, then nothing.
+    scheduler.cancel(footprint);
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("simulated_s=%.1f wakeups=%llu resumes=%llu timer_arms=%llu timer_disarms=%llu tasks_left=%zu armed_at_end=%s\n",
+                seconds, static_cast<unsigned long long>(wakeups), static_cast<unsigned long long>(scheduler.resume_count()),
+                static_cast<unsigned long long>(timer.arms), static_cast<unsigned long long>(timer.disarms),
+                scheduler.task_count(), scheduler.armed_deadline() ? "yes" : "no");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = 2000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view prefix = "--frames=";
+        const auto [ptr, ec] = arg.starts_with(prefix)
+            ? std::from_chars(arg.data() + prefix.size(), arg.data() + arg.size(), frames)
+            : std::from_chars_result{arg.data(), std::errc::invalid_argument};
+        if (ec != std::errc() || ptr != arg.data() + arg.size() || frames <= 0) {
+            std::fprintf(stderr, "Usage: ScreenLightTimelineBench [--frames=N]\n");
+            return EXIT_FAILURE;
+        }
+    }
+    std::printf("frames=%d runs=%d\n", frames, kRuns);
+    bench_resume(frames);
+    bench_session(100);
+    return EXIT_SUCCESS;
+}
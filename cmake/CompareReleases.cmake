@@ -0,0 +1,85 @@
+# Reports the binary-size and startup-time delta of an optimized ScreenLight.exe
+# against the plain release build.
+#
+# Usage:
+#   cmake -DBASELINE=<plain.exe> -DCANDIDATE=<optimized.exe> [-DEMULATOR=wine] [-DRUNS=9] \
+#         -P cmake/CompareReleases.cmake
+#
+# Startup time is the wall time of `<exe> --exit-after-startup`, which presents the
+# first frame and then shuts down cleanly. The median of RUNS launches is reported.
+
+# string(TIMESTAMP ... "%f") needs CMake 3.23.
+cmake_minimum_required(VERSION 3.23)
+
+if(NOT BASELINE OR NOT CANDIDATE)
+    message(FATAL_ERROR "Both BASELINE and CANDIDATE must be set.")
+endif()
+foreach(exe IN ITEMS "${BASELINE}" "${CANDIDATE}")
+    if(NOT EXISTS "${exe}")
+        message(FATAL_ERROR "Executable not found: ${exe}")
+    endif()
+endforeach()
+if(NOT RUNS)
+    set(RUNS 9)
+endif()
+
+# Current time in microseconds since the epoch. A single TIMESTAMP call keeps the
+# seconds and the six-digit microsecond fraction consistent with each other.
+function(now_us out)
+    string(TIMESTAMP value "%s%f" UTC)
+    set(${out} ${value} PARENT_SCOPE)
+endfunction()
+
+# Median startup time of an executable, in microseconds.
+function(measure_startup exe out)
+    set(samples "")
+    foreach(run RANGE 1 ${RUNS})
+        now_us(start)
+        execute_process(
+            COMMAND ${EMULATOR} "${exe}" --exit-after-startup
+            RESULT_VARIABLE result
+            OUTPUT_QUIET ERROR_QUIET
+            TIMEOUT 60
+        )
+        now_us(end)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "${exe} --exit-after-startup failed: ${result}")
+        endif()
+        math(EXPR elapsed "${end} - ${start}")
+        # Zero-pad so the lexicographic sort below orders numerically.
+        string(LENGTH "${elapsed}" digits)
+        math(EXPR padding "12 - ${digits}")
+        string(REPEAT "0" ${padding} zeros)
+        list(APPEND samples "${zeros}${elapsed}")
+    endforeach()
+    list(SORT samples)
+    math(EXPR middle "${RUNS} / 2")
+    list(GET samples ${middle} median)
+    math(EXPR median "${median} + 0") # Strip the padding.
+    set(${out} ${median} PARENT_SCOPE)
+endfunction()
+
+# Signed change from base to value in tenths of a percent, formatted as +x.y%.
+function(format_delta base value out)
+    math(EXPR permille "(${value} - ${base}) * 1000 / ${base}")
+    if(permille LESS 0)
+        set(sign "-")
+        math(EXPR permille "0 - ${permille}")
+    else()
+        set(sign "+")
+    endif()
+    math(EXPR whole "${permille} / 10")
+    math(EXPR tenth "${permille} % 10")
+    set(${out} "${sign}${whole}.${tenth}%" PARENT_SCOPE)
+endfunction()
+
+file(SIZE "${BASELINE}" baselineSize)
+file(SIZE "${CANDIDATE}" candidateSize)
+measure_startup("${BASELINE}" baselineStartup)
+measure_startup("${CANDIDATE}" candidateStartup)
+
+format_delta(${baselineSize} ${candidateSize} sizeDelta)
+format_delta(${baselineStartup} ${candidateStartup} startupDelta)
+
+message(STATUS "Binary size:  ${baselineSize} -> ${candidateSize} bytes (${sizeDelta})")
+message(STATUS "Startup time: ${baselineStartup} -> ${candidateStartup} us median of ${RUNS} (${startupDelta})")
@@ -0,0 +1,316 @@
+#include "ambient.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+#include "file_io.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h> // Before windows.h, which would otherwise pull in the old winsock.h
+#include <windows.h>
+#else
+#include <arpa/inet.h>  // For htons and htonl
+#include <cerrno>
+#include <fcntl.h>      // For open and O_NONBLOCK
+#include <netinet/in.h> // For sockaddr_in
+#include <sys/socket.h> // For socket, bind and recv
+#include <sys/stat.h>   // For fstat
+#include <unistd.h>     // For read, lseek and close
+#endif
+
+namespace ambient {
+
+namespace {
+    constexpr std::size_t kReadChunk = 4096;
+
+#ifdef _WIN32
+    // A file read as it grows. A file rewritten from the start (shorter than the read
+    // position) is read again from its beginning.
+    class FileSource final : public Source {
+    public:
+        explicit FileSource(HANDLE file) : m_file(file) {}
+        ~FileSource() override { CloseHandle(m_file); }
+
+        void read(std::string& out) override {
+            LARGE_INTEGER size = {};
+            LARGE_INTEGER position = {};
+            LARGE_INTEGER zero = {};
+            if (GetFileSizeEx(m_file, &size) && SetFilePointerEx(m_file, zero, &position, FILE_CURRENT)
+                && size.QuadPart < position.QuadPart) {
+                SetFilePointerEx(m_file, zero, NULL, FILE_BEGIN);
+            }
+            char buffer[kReadChunk];
+            DWORD got = 0;
+            while (ReadFile(m_file, buffer, sizeof(buffer), &got, NULL) && got > 0) {
+                out.append(buffer, got);
+            }
+        }
+
+    private:
+        HANDLE m_file;
+    };
+
+    // A named pipe client. The pipe is (re)connected on each read until a server exists,
+    // and only the bytes already waiting are read, so a quiet server never blocks.
+    class PipeSource final : public Source {
+    public:
+        explicit PipeSource(std::wstring path) : m_path(std::move(path)) {}
+        ~PipeSource() override { disconnect(); }
+
+        void read(std::string& out) override {
+            if (m_pipe == INVALID_HANDLE_VALUE) {
+                m_pipe = CreateFileW(m_path.c_str(), GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+                if (m_pipe == INVALID_HANDLE_VALUE) {
+                    return;
+                }
+            }
+            DWORD available = 0;
+            while (true) {
+                if (!PeekNamedPipe(m_pipe, NULL, 0, NULL, &available, NULL)) {
+                    disconnect(); // The server went away; reconnect on a later read.
+                    return;
+                }
+                if (available == 0) {
+                    return;
+                }
+                char buffer[kReadChunk];
+                DWORD got = 0;
+                if (!ReadFile(m_pipe, buffer, std::min<DWORD>(available, sizeof(buffer)), &got, NULL)) {
+                    disconnect();
+                    return;
+                }
+                out.append(buffer, got);
+            }
+        }
+
+    private:
+        void disconnect() {
+            if (m_pipe != INVALID_HANDLE_VALUE) CloseHandle(m_pipe);
+            m_pipe = INVALID_HANDLE_VALUE;
+        }
+
+        std::wstring m_path;
+        HANDLE m_pipe = INVALID_HANDLE_VALUE;
+    };
+
+    using SocketHandle = SOCKET;
+    constexpr SocketHandle kNoSocket = INVALID_SOCKET;
+    void close_socket(SocketHandle s) { closesocket(s); }
+#else
+    // A file read as it grows, or a FIFO. Opened non-blocking, so a FIFO without a
+    // writer reads as empty. A file rewritten from the start is read again from its beginning.
+    class FileSource final : public Source {
+    public:
+        explicit FileSource(int fd) : m_fd(fd) {}
+        ~FileSource() override { ::close(m_fd); }
+
+        void read(std::string& out) override {
+            struct stat info = {};
+            if (fstat(m_fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size < lseek(m_fd, 0, SEEK_CUR)) {
+                lseek(m_fd, 0, SEEK_SET);
+            }
+            char buffer[kReadChunk];
+            ssize_t got;
+            while ((got = ::read(m_fd, buffer, sizeof(buffer))) > 0) {
+                out.append(buffer, static_cast<std::size_t>(got));
+            }
+        }
+
+    private:
+        int m_fd;
+    };
+
+    using SocketHandle = int;
+    constexpr SocketHandle kNoSocket = -1;
+    void close_socket(SocketHandle s) { ::close(s); }
+#endif
+
+    // Datagrams on the loopback interface, each one reading. Non-blocking. The socket
+    // signals an event (Windows) or is itself readable (POSIX) when a datagram arrives.
+    class UdpSource final : public Source {
+    public:
+#ifdef _WIN32
+        UdpSource(SocketHandle socket, WSAEVENT event) : m_socket(socket), m_event(event) {}
+        ~UdpSource() override {
+            close_socket(m_socket);
+            WSACloseEvent(m_event);
+            WSACleanup();
+        }
+
+        WaitHandle wait_handle() const override { return m_event; }
+#else
+        explicit UdpSource(SocketHandle socket) : m_socket(socket) {}
+        ~UdpSource() override { close_socket(m_socket); }
+
+        WaitHandle wait_handle() const override { return m_socket; }
+#endif
+
+        void read(std::string& out) override {
+#ifdef _WIN32
+            // Reset before draining: a datagram arriving meanwhile signals it again.
+            WSAResetEvent(m_event);
+#endif
+            char buffer[512];
+            while (true) {
+                const auto got = recv(m_socket, buffer, static_cast<int>(sizeof(buffer)), 0);
+                if (got <= 0) {
+                    return;
+                }
+                out.append(buffer, static_cast<std::size_t>(got));
+                out.push_back('\n');
+            }
+        }
+
+    private:
+        SocketHandle m_socket;
+#ifdef _WIN32
+        WSAEVENT m_event;
+#endif
+    };
+
+    std::unique_ptr<Source> open_udp(std::string_view portText, std::string& error) {
+        int port = 0;
+        const auto [ptr, ec] = std::from_chars(portText.data(), portText.data() + portText.size(), port);
+        if (ec != std::errc() || ptr != portText.data() + portText.size() || port <= 0 || port > 65535) {
+            error = "invalid UDP port";
+            return nullptr;
+        }
+#ifdef _WIN32
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            error = "could not start Winsock";
+            return nullptr;
+        }
+#endif
+        const SocketHandle s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bool ready = s != kNoSocket && bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+#ifdef _WIN32
+        // Event selection also makes the socket non-blocking.
+        const WSAEVENT event = ready ? WSACreateEvent() : WSA_INVALID_EVENT;
+        ready = event != WSA_INVALID_EVENT && WSAEventSelect(s, event, FD_READ) == 0;
+#else
+        ready = ready && fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+        if (!ready) {
+            if (s != kNoSocket) close_socket(s);
+#ifdef _WIN32
+            if (event != WSA_INVALID_EVENT) WSACloseEvent(event);
+            WSACleanup();
+#endif
+            error = "could not bind 127.0.0.1:" + std::string(portText);
+            return nullptr;
+        }
+#ifdef _WIN32
+        return std::make_unique<UdpSource>(s, event);
+#else
+        return std::make_unique<UdpSource>(s);
+#endif
+    }
+}
+
+std::unique_ptr<Source> open_source(std::string_view spec, std::string& error) {
+    const std::size_t colon = spec.find(':');
+    const std::string_view kind = spec.substr(0, colon);
+    const std::string_view target = colon == std::string_view::npos ? std::string_view() : spec.substr(colon + 1);
+    if (target.empty()) {
+        error = "expected file:PATH, pipe:NAME or udp:PORT";
+        return nullptr;
+    }
+    if (kind == "udp") {
+        return open_udp(target, error);
+    }
+#ifdef _WIN32
+    if (kind == "file") {
+        HANDLE file = CreateFileW(file_io::widen(target).c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            error = "cannot open " + std::string(target);
+            return nullptr;
+        }
+        return std::make_unique<FileSource>(file);
+    }
+    if (kind == "pipe") {
+        return std::make_unique<PipeSource>(L"\\\\.\\pipe\\" + file_io::widen(target));
+    }
+#else
+    if (kind == "file" || kind == "pipe") {
+        const int fd = ::open(std::string(target).c_str(), O_RDONLY | O_NONBLOCK);
+        if (fd < 0) {
+            error = "cannot open " + std::string(target);
+            return nullptr;
+        }
+        return std::make_unique<FileSource>(fd);
+    }
+#endif
+    error = "unknown source kind '" + std::string(kind) + "'";
+    return nullptr;
+}
+
+void SampleParser::feed(std::string_view text, std::vector<double>& samples) {
+    m_partial.append(text);
+    std::size_t start = 0;
+    std::size_t end;
+    while ((end = m_partial.find('\n', start)) != std::string::npos) {
+        std::string_view line(m_partial.data() + start, end - start);
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.remove_suffix(1);
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+        double lux = 0.0;
+        const auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), lux);
+        if (ec == std::errc() && ptr == line.data() + line.size() && lux >= 0.0 && std::isfinite(lux)) {
+            samples.push_back(lux);
+        }
+        start = end + 1;
+    }
+    m_partial.erase(0, start);
+}
+
+double level_for_lux(double lux, const Tuning& tuning) {
+    const double position = std::log10(1.0 + std::max(lux, 0.0)) / std::log10(1.0 + tuning.fullLux);
+    return tuning.minGrayLevel + (255 - tuning.minGrayLevel) * std::clamp(position, 0.0, 1.0);
+}
+
+bool Controller::update(std::span<const double> lux, std::chrono::steady_clock::time_point at) {
+    if (lux.empty()) {
+        return false;
+    }
+    double level = 0.0;
+    for (const double reading : lux) {
+        level += level_for_lux(reading, m_tuning);
+    }
+    level /= static_cast<double>(lux.size());
+
+    if (!m_primed) {
+        m_filtered = level;
+        m_primed = true;
+    } else {
+        // First-order low-pass with a time constant, so the response does not depend on
+        // how often the sensor reports.
+        const double dt = std::chrono::duration<double>(at - m_last).count();
+        const double alpha = 1.0 - std::exp(-std::max(dt, 0.0) / m_tuning.timeConstantS);
+        m_filtered += alpha * (level - m_filtered);
+    }
+    m_last = at;
+
+    // Hysteresis: move to another multiple of the quantum only once the filtered level
+    // is clearly past the midpoint between the two.
+    const double quantum = m_tuning.quantum;
+    if (m_target >= 0 && std::abs(m_filtered - m_target) < quantum * (0.5 + m_tuning.hysteresis)) {
+        return false;
+    }
+    const int target = std::clamp(static_cast<int>(std::lround(m_filtered / quantum)) * m_tuning.quantum,
+                                  m_tuning.minGrayLevel, 255);
+    if (target == m_target) {
+        return false;
+    }
+    m_target = target;
+    return true;
+}
+
+} // namespace ambient
@@ -0,0 +1,92 @@
+#pragma once
+
+// Closed-loop brightness from a room light sensor. A Source delivers raw lux readings as
+// text (one number per line or datagram) from whatever feeds it: a file or FIFO, a
+// Windows named pipe, or UDP datagrams on the loopback interface. The Controller
+// low-pass filters the readings on a perceptual (logarithmic) scale and quantizes the
+// result to a coarse grid of gray levels with hysteresis, so its target only changes
+// when the room really changed. The application reads the source when its wait handle
+// is signalled, or polls it on the timeline if it has none, only while the light is
+// visible. It fades towards each new target at a limited rate; a burst of readings that
+// does not move the quantized target costs no repaint at all.
+
+#include <chrono>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.h"
+
+namespace ambient {
+
+// A light-level input. read() never blocks: it appends whatever text arrived since the
+// last call, which may be nothing. A source whose writer is not there yet (an absent
+// pipe server, a FIFO without a writer) simply reads nothing until it is.
+class Source {
+public:
+#ifdef _WIN32
+    using WaitHandle = void*; // An event HANDLE.
+    static constexpr WaitHandle kNoWaitHandle = nullptr;
+#else
+    using WaitHandle = int;   // A readable file descriptor.
+    static constexpr WaitHandle kNoWaitHandle = -1;
+#endif
+
+    virtual ~Source() = default;
+    virtual void read(std::string& out) = 0;
+
+    // Signalled when text may be waiting, for the owner's main wait. Sources that cannot
+    // be waited on (files, named pipes) return kNoWaitHandle and are polled instead.
+    [[nodiscard]] virtual WaitHandle wait_handle() const { return kNoWaitHandle; }
+};
+
+// Opens a source from its spec: "file:PATH" (a file read as it grows, or a FIFO on
+// POSIX), "pipe:NAME" (the Windows named pipe \\.\pipe\NAME) or "udp:PORT" (datagrams
+// sent to 127.0.0.1:PORT). Returns nullptr with a reason if the spec is invalid or the
+// source cannot be opened.
+std::unique_ptr<Source> open_source(std::string_view spec, std::string& error);
+
+// Splits source text into readings: one non-negative number per line. Other lines are
+// skipped; a line cut off at the end of the text is kept until the rest arrives.
+class SampleParser {
+public:
+    void feed(std::string_view text, std::vector<double>& samples);
+
+private:
+    std::string m_partial;
+};
+
+struct Tuning {
+    double fullLux = config::kAmbientFullLux;           // At or above this the light is at full brightness.
+    int minGrayLevel = config::kAmbientMinGrayLevel;    // The level in a dark room.
+    int quantum = config::kAmbientQuantum;              // Targets are multiples of this many levels.
+    double timeConstantS = config::kAmbientTimeConstantS; // Low-pass filter time constant.
+    double hysteresis = 0.25; // Extra fraction of a quantum the filtered level must move past the midpoint.
+};
+
+// The unquantized gray level for a reading: logarithmic in lux, like perceived brightness.
+double level_for_lux(double lux, const Tuning& tuning);
+
+class Controller {
+public:
+    explicit Controller(const Tuning& tuning = {}) : m_tuning(tuning) {}
+
+    // Adds the readings that arrived by the given time; several readings from one poll
+    // count as one averaged observation. Returns true if the quantized target changed.
+    bool update(std::span<const double> lux, std::chrono::steady_clock::time_point at);
+
+    [[nodiscard]] bool has_target() const { return m_target >= 0; }
+    [[nodiscard]] int target() const { return m_target; }
+    [[nodiscard]] double filtered_level() const { return m_filtered; }
+
+private:
+    Tuning m_tuning;
+    bool m_primed = false;
+    double m_filtered = 0.0;
+    std::chrono::steady_clock::time_point m_last;
+    int m_target = -1;
+};
+
+} // namespace ambient
@@ -0,0 +1,113 @@
+#pragma once
+
+// Warm and cool white for the light, from a table of blackbody colours computed at
+// compile time. Each entry is the colour of a blackbody at that temperature (Tanner
+// Helland's fit of Mitchell Charity's data), white-balanced so that the neutral
+// temperature is exactly (255, 255, 255). The light's colour is then one table lookup
+// scaled by the gray level, with no floating point at run time: neutral temperature
+// gives the same gray the light has always shown.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "config.h"
+
+namespace color {
+
+struct Rgb {
+    std::uint8_t r;
+    std::uint8_t g;
+    std::uint8_t b;
+
+    bool operator==(const Rgb&) const = default;
+};
+
+namespace detail {
+    // Constant-evaluable natural logarithm and exponential, accurate to well under a
+    // colour step for the range used here. They only ever run in the compiler.
+    constexpr double kLn2 = 0.69314718055994530942;
+
+    constexpr double ln(double x) {
+        int exponent = 0;
+        while (x >= 2.0) { x /= 2.0; ++exponent; }
+        while (x < 1.0) { x *= 2.0; --exponent; }
+        // ln(x) = 2 atanh((x - 1) / (x + 1)) converges quickly for x in [1, 2).
+        const double t = (x - 1.0) / (x + 1.0);
+        double term = t;
+        double sum = 0.0;
+        for (int n = 1; n < 60; n += 2) {
+            sum += term / n;
+            term *= t * t;
+        }
+        return exponent * kLn2 + 2.0 * sum;
+    }
+
+    constexpr double exp(double y) {
+        int halvings = 0;
+        while (y > 0.5 || y < -0.5) { y /= 2.0; ++halvings; }
+        double term = 1.0;
+        double sum = 1.0;
+        for (int n = 1; n < 30; ++n) {
+            term *= y / n;
+            sum += term;
+        }
+        while (halvings-- > 0) sum *= sum;
+        return sum;
+    }
+
+    constexpr double pow(double base, double exponent) { return exp(exponent * ln(base)); }
+
+    constexpr double clamp255(double value) { return value < 0.0 ? 0.0 : value > 255.0 ? 255.0 : value; }
+
+    // Tanner Helland's blackbody approximation, in 0-255 per channel.
+    struct Channels {
+        double r, g, b;
+    };
+
+    constexpr Channels blackbody(int kelvin) {
+        const double t = kelvin / 100.0;
+        const double r = t <= 66.0 ? 255.0 : 329.698727446 * pow(t - 60.0, -0.1332047592);
+        const double g = t <= 66.0 ? 99.4708025861 * ln(t) - 161.1195681661 : 288.1221695283 * pow(t - 60.0, -0.0755148492);
+        const double b = t >= 66.0 ? 255.0 : t <= 19.0 ? 0.0 : 138.5177312231 * ln(t - 10.0) - 305.0447927307;
+        return {clamp255(r), clamp255(g), clamp255(b)};
+    }
+
+    constexpr std::uint8_t to_byte(double value) { return static_cast<std::uint8_t>(clamp255(value) + 0.5); }
+}
+
+constexpr std::size_t kTableSize = (config::kMaxKelvin - config::kMinKelvin) / config::kKelvinResolution + 1;
+
+// White-balanced blackbody colours from kMinKelvin to kMaxKelvin in kKelvinResolution steps.
+constexpr std::array<Rgb, kTableSize> kBlackbodyTable = [] {
+    std::array<Rgb, kTableSize> table{};
+    const detail::Channels white = detail::blackbody(config::kNeutralKelvin);
+    for (std::size_t i = 0; i < kTableSize; ++i) {
+        const detail::Channels c = detail::blackbody(config::kMinKelvin + static_cast<int>(i) * config::kKelvinResolution);
+        table[i] = {detail::to_byte(c.r * 255.0 / white.r), detail::to_byte(c.g * 255.0 / white.g),
+                    detail::to_byte(c.b * 255.0 / white.b)};
+    }
+    return table;
+}();
+
+static_assert(kBlackbodyTable[(config::kNeutralKelvin - config::kMinKelvin) / config::kKelvinResolution] == Rgb{255, 255, 255},
+              "The neutral temperature must be pure white");
+
+// Clamps a temperature to the table's range and resolution.
+constexpr int clamp_kelvin(int kelvin) {
+    const int clamped = kelvin < config::kMinKelvin ? config::kMinKelvin : kelvin > config::kMaxKelvin ? config::kMaxKelvin : kelvin;
+    return clamped - (clamped - config::kMinKelvin) % config::kKelvinResolution;
+}
+
+// The light's colour: the temperature's white scaled by the gray level (0-255).
+constexpr Rgb light_color(int grayLevel, int kelvin) {
+    const Rgb white = kBlackbodyTable[static_cast<std::size_t>((clamp_kelvin(kelvin) - config::kMinKelvin) / config::kKelvinResolution)];
+    const auto scale = [grayLevel](std::uint8_t channel) {
+        return static_cast<std::uint8_t>((channel * grayLevel + 127) / 255);
+    };
+    return {scale(white.r), scale(white.g), scale(white.b)};
+}
+
+static_assert(light_color(128, config::kNeutralKelvin) == Rgb{128, 128, 128}, "Neutral light must stay gray");
+
+} // namespace color
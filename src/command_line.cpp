@@ -0,0 +1,263 @@
+#include "command_line.h"
+
+#include <climits>
+
+namespace cli {
+
+namespace {
+    constexpr bool is_blank(wchar_t c) { return c == L' ' || c == L'\t'; }
+
+    // Parses a whole view as a decimal integer, optionally negative.
+    bool parse_int(std::wstring_view text, int& value) {
+        bool negative = false;
+        if (!text.empty() && text.front() == L'-') {
+            negative = true;
+            text.remove_prefix(1);
+        }
+        if (text.empty()) {
+            return false;
+        }
+        long long result = 0;
+        for (const wchar_t c : text) {
+            if (c < L'0' || c > L'9') {
+                return false;
+            }
+            result = result * 10 + (c - L'0');
+            if (result > INT_MAX) {
+                return false;
+            }
+        }
+        value = static_cast<int>(negative ? -result : result);
+        return true;
+    }
+
+    bool parse_positive(std::wstring_view text, std::optional<int>& value) {
+        int parsed = 0;
+        if (!parse_int(text, parsed) || parsed <= 0) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    // Parses a rectangle written as L,T,R,B. Fails unless it is well formed and non-empty.
+    bool parse_rect(std::wstring_view text, ScreenRect& rect) {
+        int values[4] = {};
+        for (int i = 0; i < 4; ++i) {
+            const std::size_t comma = i < 3 ? text.find(L',') : text.size();
+            if (comma == std::wstring_view::npos || !parse_int(text.substr(0, comma), values[i])) {
+                return false;
+            }
+            text.remove_prefix(i < 3 ? comma + 1 : comma);
+        }
+        if (values[2] <= values[0] || values[3] <= values[1]) {
+            return false;
+        }
+        rect = {values[0], values[1], values[2], values[3]};
+        return true;
+    }
+
+    bool parse_motion(std::wstring_view name, Options& options) {
+        if (name == L"bounce") options.motion = MotionKind::Bounce;
+        else if (name == L"jiggle") options.motion = MotionKind::Jiggle;
+        else if (name == L"orbit") options.motion = MotionKind::Orbit;
+        else if (name == L"nudge") options.motion = MotionKind::IdleNudge;
+        else return false;
+        return true;
+    }
+
+    bool parse_bounds(std::wstring_view name, Options& options) {
+        if (name == L"primary") options.bounds = BoundsKind::PrimaryScreen;
+        else if (name == L"virtual") options.bounds = BoundsKind::VirtualDesktop;
+        else if (parse_rect(name, options.boundsRect)) options.bounds = BoundsKind::SubRect;
+        else return false;
+        return true;
+    }
+
+    bool parse_path(std::wstring_view path, std::wstring_view& value) {
+        if (path.empty()) {
+            return false;
+        }
+        value = path;
+        return true;
+    }
+
+    struct Option {
+        std::wstring_view name;
+        bool takesValue;
+        bool (*apply)(std::wstring_view value, Options& options);
+    };
+
+    // The options in the order --help would list them. Flags ignore their value argument.
+    constexpr Option kOptions[] = {
+        {L"verbose", false, [](std::wstring_view, Options& o) { o.verbose = true; return true; }},
+        {L"edge-light", false, [](std::wstring_view, Options& o) { o.edgeLight = true; return true; }},
+        {L"no-motion", false, [](std::wstring_view, Options& o) { o.noMotion = true; return true; }},
+        {L"keep-awake-only", false, [](std::wstring_view, Options& o) { o.keepAwakeOnly = true; return true; }},
+        {L"exit-after-startup", false, [](std::wstring_view, Options& o) { o.exitAfterStartup = true; return true; }},
+        {L"trim-after-startup", false, [](std::wstring_view, Options& o) { o.trimAfterStartup = true; return true; }},
+        {L"no-hotkeys", false, [](std::wstring_view, Options& o) { o.noHotKeys = true; return true; }},
+        {L"dither", false, [](std::wstring_view, Options& o) { o.dither = true; return true; }},
+        {L"gamma-ramp", false, [](std::wstring_view, Options& o) { o.gammaRamp = true; return true; }},
+        {L"brightness", true, [](std::wstring_view v, Options& o) {
+            int level = 0;
+            if (!parse_int(v, level) || level < 0 || level > 255) return false;
+            o.brightness = level;
+            return true;
+        }},
+        {L"color-temperature", true, [](std::wstring_view v, Options& o) {
+            int kelvin = 0;
+            if (!parse_int(v, kelvin) || kelvin < config::kMinKelvin || kelvin > config::kMaxKelvin) return false;
+            o.kelvin = kelvin;
+            return true;
+        }},
+        {L"fps", true, [](std::wstring_view v, Options& o) {
+            int fps = 0;
+            if (!parse_int(v, fps) || fps <= 0 || fps > 1000) return false;
+            o.fps = fps;
+            return true;
+        }},
+        {L"monitor", true, [](std::wstring_view v, Options& o) {
+            int index = 0;
+            if (!parse_int(v, index) || index < 0) return false;
+            o.monitor = index;
+            return true;
+        }},
+        {L"stall-threshold", true, [](std::wstring_view v, Options& o) { return parse_positive(v, o.stallThresholdMs); }},
+        {L"battery-frame-delay", true, [](std::wstring_view v, Options& o) { return parse_positive(v, o.batteryFrameDelayMs); }},
+        {L"footprint-interval", true, [](std::wstring_view v, Options& o) { return parse_positive(v, o.footprintIntervalMs); }},
+        {L"cpu-budget", true, [](std::wstring_view v, Options& o) {
+            int permille = 0;
+            if (!parse_int(v, permille) || permille < 0 || permille > 1000) return false;
+            o.cpuBudgetPermille = permille;
+            return true;
+        }},
+        {L"motion", true, [](std::wstring_view v, Options& o) { return parse_motion(v, o); }},
+        {L"bounds", true, [](std::wstring_view v, Options& o) { return parse_bounds(v, o); }},
+        {L"record", true, [](std::wstring_view v, Options& o) { return parse_path(v, o.recordPath); }},
+        {L"config", true, [](std::wstring_view v, Options& o) { return parse_path(v, o.configPath); }},
+        {L"state", true, [](std::wstring_view v, Options& o) { return parse_path(v, o.statePath); }},
+        {L"flight-recorder", true, [](std::wstring_view v, Options& o) { return parse_path(v, o.flightPath); }},
+        {L"ambient", true, [](std::wstring_view v, Options& o) { return parse_path(v, o.ambientSpec); }},
+        {L"schedule", true, [](std::wstring_view v, Options& o) { return parse_path(v, o.schedulePath); }},
+    };
+
+    void apply_argument(std::wstring_view argument, Options& options) {
+        bool applied = false;
+        if (argument.starts_with(L"--")) {
+            const std::wstring_view body = argument.substr(2);
+            const std::size_t equals = body.find(L'=');
+            const std::wstring_view name = body.substr(0, equals);
+            const bool hasValue = equals != std::wstring_view::npos;
+            for (const Option& option : kOptions) {
+                if (option.name == name) {
+                    applied = option.takesValue == hasValue && option.apply(hasValue ? body.substr(equals + 1) : std::wstring_view(), options);
+                    break;
+                }
+            }
+        }
+        if (!applied && options.rejected.empty()) {
+            options.rejected = argument;
+        }
+    }
+
+    // Unescapes a quoted argument into the scratch buffer, following the
+    // CommandLineToArgvW rules: 2n backslashes before a quote give n backslashes and
+    // toggle quoting, 2n+1 give n backslashes and a literal quote, and "" inside quotes
+    // gives a literal quote. Backslashes not followed by a quote are literal.
+    bool unescape(std::wstring_view raw, Options& options, std::wstring_view& argument) {
+        wchar_t* const begin = options.scratch + options.scratchUsed;
+        wchar_t* const end = options.scratch + Options::kScratchSize;
+        wchar_t* out = begin;
+        std::size_t backslashes = 0;
+        bool quoted = false;
+        auto emit = [&](wchar_t c, std::size_t count) {
+            if (static_cast<std::size_t>(end - out) < count) return false;
+            for (std::size_t i = 0; i < count; ++i) *out++ = c;
+            return true;
+        };
+        for (std::size_t i = 0; i < raw.size(); ++i) {
+            const wchar_t c = raw[i];
+            if (c == L'\\') {
+                ++backslashes;
+                continue;
+            }
+            if (c == L'"') {
+                if (!emit(L'\\', backslashes / 2)) return false;
+                if (backslashes % 2 == 1) {
+                    if (!emit(L'"', 1)) return false;
+                } else if (quoted && i + 1 < raw.size() && raw[i + 1] == L'"') {
+                    if (!emit(L'"', 1)) return false;
+                    ++i;
+                } else {
+                    quoted = !quoted;
+                }
+                backslashes = 0;
+                continue;
+            }
+            if (!emit(L'\\', backslashes) || !emit(c, 1)) return false;
+            backslashes = 0;
+        }
+        if (!emit(L'\\', backslashes)) return false;
+        argument = std::wstring_view(begin, static_cast<std::size_t>(out - begin));
+        options.scratchUsed += argument.size();
+        return true;
+    }
+}
+
+bool parse(std::wstring_view commandLine, Options& options) {
+    std::size_t pos = 0;
+    const std::size_t length = commandLine.size();
+
+    // The program name has its own rule: it is quoted or ends at the first blank, and
+    // backslashes are never escapes in it.
+    if (pos < length && commandLine[pos] == L'"') {
+        const std::size_t close = commandLine.find(L'"', pos + 1);
+        pos = close == std::wstring_view::npos ? length : close + 1;
+    }
+    while (pos < length && !is_blank(commandLine[pos])) ++pos;
+
+    bool ok = true;
+    while (true) {
+        while (pos < length && is_blank(commandLine[pos])) ++pos;
+        if (pos == length) {
+            break;
+        }
+        // Find the end of the argument: the first blank outside quotes.
+        const std::size_t start = pos;
+        std::size_t backslashes = 0;
+        bool quoted = false;
+        bool hasQuote = false;
+        for (; pos < length; ++pos) {
+            const wchar_t c = commandLine[pos];
+            if (c == L'\\') {
+                ++backslashes;
+                continue;
+            }
+            if (c == L'"') {
+                hasQuote = true;
+                if (backslashes % 2 == 0) {
+                    if (quoted && pos + 1 < length && commandLine[pos + 1] == L'"') {
+                        ++pos; // "" inside quotes is a literal quote.
+                    } else {
+                        quoted = !quoted;
+                    }
+                }
+            } else if (is_blank(c) && !quoted) {
+                break;
+            }
+            backslashes = 0;
+        }
+        const std::wstring_view raw = commandLine.substr(start, pos - start);
+        std::wstring_view argument = raw;
+        if (hasQuote && !unescape(raw, options, argument)) {
+            ok = false;
+            if (options.rejected.empty()) options.rejected = raw;
+            continue;
+        }
+        apply_argument(argument, options);
+    }
+    return ok;
+}
+
+} // namespace cli
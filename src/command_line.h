@@ -0,0 +1,69 @@
+#pragma once
+
+// Typed command-line options, parsed in one pass over the raw wide command line
+// (GetCommandLineW) without allocating. Arguments are split with the same quoting
+// rules as CommandLineToArgvW; an argument without quotes is returned as a view into
+// the command line itself, and only quoted arguments are unescaped, into a fixed
+// buffer inside Options. Parsing never initializes anything: the options only say
+// which subsystems the application should bring up.
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include "mouse_mover.h" // For MotionKind, BoundsKind and ScreenRect
+
+namespace cli {
+
+struct Options {
+    Options() = default;
+    // Path options may point into scratch, so an Options must stay where it was parsed.
+    Options(const Options&) = delete;
+    Options& operator=(const Options&) = delete;
+
+    bool verbose = false;          // --verbose
+    bool edgeLight = false;        // --edge-light
+    bool noMotion = false;         // --no-motion: start with motion off; its thread starts only if turned on.
+    bool keepAwakeOnly = false;    // --keep-awake-only: no window, motion or paint; only the power request.
+    bool exitAfterStartup = false; // --exit-after-startup
+    bool trimAfterStartup = false; // --trim-after-startup
+    bool noHotKeys = false;        // --no-hotkeys: only react to keys while the window has focus.
+    bool dither = false;           // --dither: Shift steps a sixteenth of a level, dithered between levels.
+    bool gammaRamp = false;        // --gamma-ramp: show the light through the display's gamma ramp, not the paint.
+
+    std::optional<int> brightness;          // --brightness=N, 0-255
+    std::optional<int> kelvin;              // --color-temperature=K
+    std::optional<int> fps;                 // --fps=N, motion ticks per second
+    std::optional<int> monitor;             // --monitor=K, zero-based in enumeration order
+    std::optional<int> stallThresholdMs;    // --stall-threshold=MS
+    std::optional<int> batteryFrameDelayMs; // --battery-frame-delay=MS
+    std::optional<int> footprintIntervalMs; // --footprint-interval=MS
+    std::optional<int> cpuBudgetPermille;   // --cpu-budget=PERMILLE, 0 for unlimited
+
+    std::optional<MotionKind> motion; // --motion=bounce|jiggle|orbit|nudge
+    std::optional<BoundsKind> bounds; // --bounds=primary|virtual|L,T,R,B
+    ScreenRect boundsRect{0, 0, 0, 0}; // The rectangle for --bounds=L,T,R,B.
+
+    std::wstring_view recordPath;   // --record=PATH
+    std::wstring_view configPath;   // --config=PATH
+    std::wstring_view statePath;    // --state=PATH
+    std::wstring_view flightPath;   // --flight-recorder=PATH
+    std::wstring_view ambientSpec;  // --ambient=file:PATH|pipe:NAME|udp:PORT
+    std::wstring_view schedulePath; // --schedule=PATH
+
+    // The first argument that was not understood (unknown or with a bad value), for a
+    // warning once logging is up. Later arguments are still parsed.
+    std::wstring_view rejected;
+
+    // Unescaped copies of quoted arguments.
+    static constexpr std::size_t kScratchSize = 2048;
+    wchar_t scratch[kScratchSize];
+    std::size_t scratchUsed = 0;
+};
+
+// Parses a full command line as returned by GetCommandLineW, skipping the program
+// name. Returns false if an argument could not be stored (a quoted argument longer
+// than the scratch space); the options parsed so far stay valid.
+bool parse(std::wstring_view commandLine, Options& options);
+
+} // namespace cli
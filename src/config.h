@@ -0,0 +1,43 @@
+#pragma once
+
+// Use a dedicated namespace for configuration constants to keep them organized and reusable.
+namespace config {
+    constexpr int kInitialGrayLevel = 255;
+    constexpr int kInitialX = 100;
+    constexpr int kInitialY = 100;
+    constexpr int kVelocity = 2;
+    // Using unsigned int (UINT) for tick durations to match the timer APIs. ~60 FPS
+    constexpr unsigned int kFrameDelayMs = 16;
+    // Width of the lit border band in edge-light mode, and how far Left/Right move it.
+    constexpr int kEdgeBandWidth = 96;
+    constexpr int kEdgeBandStep = 16;
+    constexpr int kEdgeBandMin = 8;
+    // A dispatch running longer than this is reported as a message-loop stall.
+    constexpr int kStallThresholdMs = 200;
+    // Reduced motion tick on battery power. ~20 FPS
+    constexpr unsigned int kBatteryFrameDelayMs = 50;
+    // Footprint sampling period. Memory moves slowly, so this is far coarser than a frame.
+    constexpr unsigned int kFootprintIntervalMs = 10000;
+    // CPU budget of the process, in thousandths of one core, and how the governor keeps
+    // to it: how often it samples, the slowest tick it may stretch to, and the system
+    // load at which it backs off regardless of its own usage.
+    constexpr int kCpuBudgetPermille = 10;
+    constexpr unsigned int kGovernorIntervalMs = 2000;
+    constexpr unsigned int kGovernorMaxFrameDelayMs = 200;
+    constexpr int kGovernorSystemBusyPercent = 90;
+    // Colour temperature of the light, in Kelvin. Neutral is plain gray; W and C step
+    // warmer and cooler by kKelvinStep (kKelvinResolution with Shift).
+    constexpr int kNeutralKelvin = 6500;
+    constexpr int kMinKelvin = 1900;
+    constexpr int kMaxKelvin = 10000;
+    constexpr int kKelvinResolution = 100;
+    constexpr int kKelvinStep = 500;
+    // Ambient light control (--ambient=SPEC): how room light maps to gray levels, and
+    // how often the sensor is read and how fast the light follows it.
+    constexpr double kAmbientFullLux = 1000.0;
+    constexpr int kAmbientMinGrayLevel = 16;
+    constexpr int kAmbientQuantum = 4;
+    constexpr double kAmbientTimeConstantS = 2.0;
+    constexpr unsigned int kAmbientPollMs = 100;
+    constexpr int kAmbientLevelsPerSecond = 40;
+}
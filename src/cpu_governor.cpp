@@ -0,0 +1,106 @@
+#include "cpu_governor.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cstdio>         // For reading /proc/stat
+#include <sys/resource.h> // For getrusage
+#endif
+
+namespace governor {
+
+#ifdef _WIN32
+
+namespace {
+    std::uint64_t ticks(const FILETIME& time) {
+        return (static_cast<std::uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    }
+}
+
+CpuSample take_sample() {
+    CpuSample sample;
+    sample.at = std::chrono::steady_clock::now();
+    FILETIME created, exited, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        // FILETIME counts 100 ns units.
+        sample.processCpu = std::chrono::microseconds((ticks(kernel) + ticks(user)) / 10);
+    }
+    FILETIME idle, systemKernel, systemUser;
+    if (GetSystemTimes(&idle, &systemKernel, &systemUser)) {
+        // System kernel time includes the idle time.
+        sample.systemTotal = ticks(systemKernel) + ticks(systemUser);
+        sample.systemBusy = sample.systemTotal - ticks(idle);
+    }
+    return sample;
+}
+
+#else
+
+CpuSample take_sample() {
+    CpuSample sample;
+    sample.at = std::chrono::steady_clock::now();
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        const auto micros = [](const timeval& t) { return std::chrono::seconds(t.tv_sec) + std::chrono::microseconds(t.tv_usec); };
+        sample.processCpu = micros(usage.ru_utime) + micros(usage.ru_stime);
+    }
+    // The first line of /proc/stat: user nice system idle iowait irq softirq steal, in clock ticks.
+    if (std::FILE* stat = std::fopen("/proc/stat", "r")) {
+        unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+        if (std::fscanf(stat, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &user, &nice, &system, &idle, &iowait, &irq,
+                        &softirq, &steal) >= 4) {
+            sample.systemBusy = user + nice + system + irq + softirq + steal;
+            sample.systemTotal = sample.systemBusy + idle + iowait;
+        }
+        std::fclose(stat);
+    }
+    return sample;
+}
+
+#endif
+
+bool Governor::update(const CpuSample& sample, unsigned int baseDelayMs) {
+    const unsigned int previous = m_delayMs;
+    // A new base applies at once when not throttled; while throttled it is only a floor.
+    m_delayMs = m_delayMs == m_baseDelayMs ? baseDelayMs : std::max(m_delayMs, baseDelayMs);
+    m_baseDelayMs = baseDelayMs;
+    if (!m_primed || m_budget.permille <= 0) {
+        m_primed = true;
+        m_last = sample;
+        if (m_budget.permille <= 0) {
+            m_delayMs = baseDelayMs;
+        }
+        return m_delayMs != previous;
+    }
+    const auto wall = std::chrono::duration_cast<std::chrono::microseconds>(sample.at - m_last.at);
+    if (wall.count() <= 0) {
+        return m_delayMs != previous;
+    }
+    m_usagePermille = static_cast<int>((sample.processCpu - m_last.processCpu).count() * 1000 / wall.count());
+    const std::uint64_t total = sample.systemTotal - m_last.systemTotal;
+    m_systemBusyPercent = total > 0 ? static_cast<int>((sample.systemBusy - m_last.systemBusy) * 100 / total) : 0;
+    m_last = sample;
+
+    const unsigned int ceiling = std::max(m_budget.maxFrameDelayMs, baseDelayMs);
+    const bool overBudget = m_usagePermille > m_budget.permille;
+    if (overBudget || m_systemBusyPercent >= m_budget.systemBusyPercent) {
+        // Most of the cost is per tick, so usage scales with the rate: stretch the delay
+        // by the overshoot. A saturated system alone backs off by half again.
+        const std::uint64_t stretched = overBudget
+            ? (static_cast<std::uint64_t>(m_delayMs) * m_usagePermille + m_budget.permille - 1) / m_budget.permille
+            : m_delayMs + m_delayMs / 2;
+        m_delayMs = static_cast<unsigned int>(std::min<std::uint64_t>(std::max<std::uint64_t>(stretched, m_delayMs + 1), ceiling));
+        if (m_delayMs > previous) {
+            ++m_throttles;
+        }
+    } else if (m_delayMs > baseDelayMs && m_usagePermille * 2 < m_budget.permille) {
+        // Headroom: raise the rate by a third, which keeps usage under the budget.
+        m_delayMs = std::max(baseDelayMs, m_delayMs * 3 / 4);
+    }
+    return m_delayMs != previous;
+}
+
+} // namespace governor
@@ -0,0 +1,65 @@
+#pragma once
+
+// Keeps ScreenLight inside a CPU budget on slow or busy machines. At a low rate the
+// application samples its own CPU time (GetProcessTimes / getrusage) and how busy the
+// whole system is, and the governor turns that into the frame delay the motion ticks
+// and animations use. Over budget, or with the system saturated, the delay grows in
+// proportion to the overshoot; once usage is well under the budget it shrinks back
+// towards the configured delay a step at a time, so the rate does not oscillate.
+
+#include <chrono>
+#include <cstdint>
+
+#include "config.h"
+
+namespace governor {
+
+struct CpuSample {
+    std::chrono::steady_clock::time_point at;
+    std::chrono::microseconds processCpu{0}; // User plus kernel time of this process.
+    // Busy and total CPU time of the whole system, in platform units. Only differences
+    // between two samples mean anything; both stay 0 where the platform cannot tell.
+    std::uint64_t systemBusy = 0;
+    std::uint64_t systemTotal = 0;
+};
+
+CpuSample take_sample();
+
+struct Budget {
+    int permille = config::kCpuBudgetPermille; // Of one core; 0 turns the governor off.
+    unsigned int maxFrameDelayMs = config::kGovernorMaxFrameDelayMs;
+    int systemBusyPercent = config::kGovernorSystemBusyPercent; // Throttle while the system is at least this busy.
+};
+
+class Governor {
+public:
+    explicit Governor(const Budget& budget = {}) : m_budget(budget) {}
+
+    void set_budget_permille(int permille) { m_budget.permille = permille; }
+    [[nodiscard]] int budget_permille() const { return m_budget.permille; }
+
+    // Takes a new sample, given the frame delay the settings and power source ask for.
+    // Returns true if frame_delay_ms() changed.
+    bool update(const CpuSample& sample, unsigned int baseDelayMs);
+
+    // The delay to run at: never below the base delay.
+    [[nodiscard]] unsigned int frame_delay_ms() const { return m_delayMs; }
+    [[nodiscard]] bool is_throttled() const { return m_delayMs > m_baseDelayMs; }
+    // Over the last sampling interval.
+    [[nodiscard]] int usage_permille() const { return m_usagePermille; }
+    [[nodiscard]] int system_busy_percent() const { return m_systemBusyPercent; }
+    // How many times the delay was raised.
+    [[nodiscard]] std::uint64_t throttle_count() const { return m_throttles; }
+
+private:
+    Budget m_budget;
+    bool m_primed = false;
+    CpuSample m_last;
+    unsigned int m_baseDelayMs = 0;
+    unsigned int m_delayMs = 0;
+    int m_usagePermille = 0;
+    int m_systemBusyPercent = 0;
+    std::uint64_t m_throttles = 0;
+};
+
+} // namespace governor
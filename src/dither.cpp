@@ -0,0 +1,75 @@
+#include "dither.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCREENLIGHT_DITHER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace dither {
+
+Tile make_tile(std::uint32_t base, std::uint32_t next, int fraction) {
+    Tile tile;
+#ifdef SCREENLIGHT_DITHER_SSE2
+    // One compare and select per tile row: the mask picks next where threshold < fraction.
+    const __m128i baseLanes = _mm_set1_epi32(static_cast<int>(base));
+    const __m128i nextLanes = _mm_set1_epi32(static_cast<int>(next));
+    const __m128i fractionLanes = _mm_set1_epi32(fraction);
+    for (int y = 0; y < kTileSize; ++y) {
+        const __m128i thresholds = _mm_setr_epi32(kBayer[y][0], kBayer[y][1], kBayer[y][2], kBayer[y][3]);
+        const __m128i mask = _mm_cmplt_epi32(thresholds, fractionLanes);
+        const __m128i row = _mm_or_si128(_mm_and_si128(mask, nextLanes), _mm_andnot_si128(mask, baseLanes));
+        _mm_store_si128(reinterpret_cast<__m128i*>(tile.rows[y]), row);
+    }
+#else
+    for (int y = 0; y < kTileSize; ++y) {
+        for (int x = 0; x < kTileSize; ++x) {
+            tile.rows[y][x] = kBayer[y][x] < fraction ? next : base;
+        }
+    }
+#endif
+    return tile;
+}
+
+void fill_span(std::uint32_t* row, int x, int count, int y, const Tile& tile) {
+    const std::uint32_t* pattern = tile.rows[y % kTileSize];
+    const int phase = x % kTileSize;
+    std::uint32_t* out = row + x;
+    int i = 0;
+#ifdef SCREENLIGHT_DITHER_SSE2
+    // The tile row rotated so lane 0 is column x. The pattern repeats every four pixels,
+    // so every store writes the same vector.
+    const __m128i lanes = _mm_setr_epi32(static_cast<int>(pattern[phase]), static_cast<int>(pattern[(phase + 1) % kTileSize]),
+                                         static_cast<int>(pattern[(phase + 2) % kTileSize]),
+                                         static_cast<int>(pattern[(phase + 3) % kTileSize]));
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lanes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), lanes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), lanes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 12), lanes);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lanes);
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = pattern[(phase + i) % kTileSize];
+    }
+}
+
+void fill(std::uint32_t* pixels, int width, int height, std::ptrdiff_t stride, const Tile& tile) {
+    for (int y = 0; y < height; ++y) {
+        fill_span(pixels + y * stride, 0, width, y, tile);
+    }
+}
+
+void fill_per_pixel(std::uint32_t* pixels, int width, int height, std::ptrdiff_t stride, std::uint32_t base,
+                    std::uint32_t next, int fraction) {
+    for (int y = 0; y < height; ++y) {
+        std::uint32_t* row = pixels + y * stride;
+        for (int x = 0; x < width; ++x) {
+            row[x] = kBayer[y % kTileSize][x % kTileSize] < fraction ? next : base;
+        }
+    }
+}
+
+} // namespace dither
@@ -0,0 +1,55 @@
+#pragma once
+
+// Ordered dithering between two adjacent gray levels, for brightness steps finer than a
+// panel's 8 bits. A 4x4 Bayer tile shows the next level's colour on `fraction` of its 16
+// pixels, so each gray step splits into 16 sub-steps: 12 bits of effective precision,
+// evenly spread at any distance. The tile depends only on the level, so it is built once
+// per change; filling a surface then repeats its rows, one 16-byte SSE2 store per four
+// pixels where the target has SSE2 (every x64 build) and a scalar loop elsewhere.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "color_temperature.h"
+
+namespace dither {
+
+constexpr int kTileSize = 4;
+constexpr int kSteps = kTileSize * kTileSize; // Sub-steps per gray level.
+
+// The Bayer threshold of each tile pixel. A pixel shows the next level when its
+// threshold is below the fraction, so every fraction lights an evenly spread subset.
+constexpr std::uint8_t kBayer[kTileSize][kTileSize] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+// One tile of 0xAARRGGBB pixels, the layout of a 32-bit DIB and of the headless surface.
+struct Tile {
+    alignas(16) std::uint32_t rows[kTileSize][kTileSize];
+};
+
+// Packs a colour as an opaque 0xAARRGGBB pixel.
+constexpr std::uint32_t pack(color::Rgb rgb) {
+    return 0xFF000000u | (std::uint32_t{rgb.r} << 16) | (std::uint32_t{rgb.g} << 8) | rgb.b;
+}
+
+// Builds the tile that is fraction sixteenths (0-15) of the way from base to next.
+Tile make_tile(std::uint32_t base, std::uint32_t next, int fraction);
+
+// Fills count pixels of surface row y, starting at column x of row. The tile stays
+// anchored to the surface origin, so spans and rows filled separately line up.
+void fill_span(std::uint32_t* row, int x, int count, int y, const Tile& tile);
+
+// Fills a whole surface. stride is in pixels and is negative for a bottom-up DIB, with
+// pixels pointing at its top row.
+void fill(std::uint32_t* pixels, int width, int height, std::ptrdiff_t stride, const Tile& tile);
+
+// The straightforward per-pixel version, which compares every pixel's threshold with the
+// fraction. Benchmarks measure fill against it; the application never calls it.
+void fill_per_pixel(std::uint32_t* pixels, int width, int height, std::ptrdiff_t stride, std::uint32_t base,
+                    std::uint32_t next, int fraction);
+
+} // namespace dither
@@ -0,0 +1,63 @@
+#include "file_io.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+namespace file_io {
+
+#ifdef _WIN32
+std::wstring widen(std::string_view utf8) {
+    const int size = static_cast<int>(utf8.size());
+    const int length = size > 0 ? MultiByteToWideChar(CP_UTF8, 0, utf8.data(), size, NULL, 0) : 0;
+    if (length <= 0) {
+        return {};
+    }
+    std::wstring wide(static_cast<std::size_t>(length), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, utf8.data(), size, wide.data(), length);
+    return wide;
+}
+
+std::string narrow(std::wstring_view wide) {
+    const int size = static_cast<int>(wide.size());
+    const int length = size > 0 ? WideCharToMultiByte(CP_UTF8, 0, wide.data(), size, NULL, 0, NULL, NULL) : 0;
+    if (length <= 0) {
+        return {};
+    }
+    std::string utf8(static_cast<std::size_t>(length), '\0');
+    WideCharToMultiByte(CP_UTF8, 0, wide.data(), size, utf8.data(), length, NULL, NULL);
+    return utf8;
+}
+#endif
+
+std::FILE* open_file(const std::string& utf8Path, bool forWriting) {
+#ifdef _WIN32
+    const std::wstring widePath = widen(utf8Path);
+    return widePath.empty() ? nullptr : _wfopen(widePath.c_str(), forWriting ? L"wb" : L"rb");
+#else
+    return std::fopen(utf8Path.c_str(), forWriting ? "wb" : "rb");
+#endif
+}
+
+bool remove_file(const std::string& utf8Path) {
+#ifdef _WIN32
+    const std::wstring widePath = widen(utf8Path);
+    return !widePath.empty() && _wremove(widePath.c_str()) == 0;
+#else
+    return std::remove(utf8Path.c_str()) == 0;
+#endif
+}
+
+bool replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    const std::wstring wideFrom = widen(from);
+    const std::wstring wideTo = widen(to);
+    return !wideFrom.empty() && !wideTo.empty()
+        && MoveFileExW(wideFrom.c_str(), wideTo.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+} // namespace file_io
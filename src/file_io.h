@@ -0,0 +1,29 @@
+#pragma once
+
+// Files named by UTF-8 paths. Every path in ScreenLight is UTF-8; on Windows these go
+// through the wide API, since the narrow CRT would read them in the ANSI code page and
+// fail on any non-ASCII profile or directory name.
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace file_io {
+
+// Opens a file for binary reading, or creates or truncates it for binary writing.
+std::FILE* open_file(const std::string& utf8Path, bool forWriting);
+
+// Deletes a file. Returns false if it could not be deleted, including when it is absent.
+bool remove_file(const std::string& utf8Path);
+
+// Renames from to to, replacing to if it exists.
+bool replace_file(const std::string& from, const std::string& to);
+
+#ifdef _WIN32
+// Convert between UTF-8 and the UTF-16 of the wide API. Empty for an empty input or
+// on failure.
+std::wstring widen(std::string_view utf8);
+std::string narrow(std::wstring_view wide);
+#endif
+
+} // namespace file_io
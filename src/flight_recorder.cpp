@@ -0,0 +1,223 @@
+#include "flight_recorder.h"
+
+#include <cstdio>
+#include <new>
+
+#include "file_io.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap
+#include <unistd.h>   // For ftruncate, close and getpid
+#endif
+
+namespace flight {
+
+namespace {
+    constexpr std::size_t kFileSize = sizeof(Header) + kCapacity * sizeof(Record);
+
+    // Process-local fallback used before open() or when it fails.
+    constexpr std::uint64_t kLocalCapacity = 64;
+    Header s_localHeader{};
+    Record s_localRecords[kLocalCapacity] = {};
+
+    Header* s_mappedHeader = nullptr;
+#ifdef _WIN32
+    HANDLE s_file = INVALID_HANDLE_VALUE;
+    HANDLE s_mapping = NULL;
+#endif
+
+    Calibration take_calibration() {
+        const std::uint64_t ticks = detail::ticks();
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        return {ticks, std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()};
+    }
+
+    void initialize_header(Header* header, std::uint32_t processId) {
+        header->magic = kMagic;
+        header->version = kVersion;
+        header->headerSize = sizeof(Header);
+        header->recordSize = sizeof(Record);
+        header->capacity = kCapacity;
+        header->processId = processId;
+#ifdef SCREENLIGHT_FLIGHT_TSC
+        header->clockKind = ClockKind::Tsc;
+#else
+        header->clockKind = ClockKind::SteadyNs;
+#endif
+        header->opened = take_calibration();
+    }
+}
+
+namespace detail {
+    Ring g_ring = {&s_localHeader, s_localRecords, kLocalCapacity - 1};
+}
+
+bool open(const std::string& utf8Path) {
+    if (s_mappedHeader) {
+        return true;
+    }
+    file_io::replace_file(utf8Path, utf8Path + ".prev");
+#ifdef _WIN32
+    s_file = CreateFileW(file_io::widen(utf8Path).c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL, NULL);
+    if (s_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    // Mapping with an explicit size extends the new file to it, zero-filled.
+    s_mapping = CreateFileMappingW(s_file, NULL, PAGE_READWRITE, 0, static_cast<DWORD>(kFileSize), NULL);
+    void* view = s_mapping ? MapViewOfFile(s_mapping, FILE_MAP_WRITE, 0, 0, kFileSize) : NULL;
+    if (!view) {
+        if (s_mapping) CloseHandle(s_mapping);
+        CloseHandle(s_file);
+        s_mapping = NULL;
+        s_file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    const std::uint32_t processId = GetCurrentProcessId();
+#else
+    const int fd = ::open(utf8Path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    void* view = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(kFileSize)) == 0) {
+        view = mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    const std::uint32_t processId = static_cast<std::uint32_t>(getpid());
+#endif
+    // The file is fresh and zero-filled; construct the header in place and carry over
+    // the events recorded before opening.
+    s_mappedHeader = new (view) Header{};
+    initialize_header(s_mappedHeader, processId);
+    Record* records = reinterpret_cast<Record*>(static_cast<unsigned char*>(view) + sizeof(Header));
+    const std::uint64_t early = s_localHeader.next.load(std::memory_order_relaxed);
+    const std::uint64_t first = early > kLocalCapacity ? early - kLocalCapacity : 0;
+    std::uint64_t next = 0;
+    for (std::uint64_t index = first; index < early; ++index) {
+        Record record = s_localRecords[index & (kLocalCapacity - 1)];
+        record.sequence = static_cast<std::uint32_t>(++next);
+        records[next - 1] = record;
+    }
+    s_mappedHeader->next.store(next, std::memory_order_release);
+    detail::g_ring = {s_mappedHeader, records, kCapacity - 1};
+    return true;
+}
+
+void close() {
+    if (!s_mappedHeader) {
+        return;
+    }
+    detail::g_ring = {&s_localHeader, s_localRecords, kLocalCapacity - 1};
+#ifdef _WIN32
+    UnmapViewOfFile(s_mappedHeader);
+    CloseHandle(s_mapping);
+    CloseHandle(s_file);
+    s_mapping = NULL;
+    s_file = INVALID_HANDLE_VALUE;
+#else
+    munmap(s_mappedHeader, kFileSize);
+#endif
+    s_mappedHeader = nullptr;
+}
+
+void calibrate() {
+    Header* header = detail::g_ring.header;
+    const std::uint64_t count = header->latestCount.load(std::memory_order_relaxed);
+    header->latest[count & 1] = take_calibration();
+    header->latestCount.store(count + 1, std::memory_order_release);
+}
+
+bool decode_file(const std::string& utf8Path, Decoded& out, std::string& error) {
+    std::FILE* file = file_io::open_file(utf8Path, false);
+    if (!file) {
+        error = "cannot open the file";
+        return false;
+    }
+    // The header holds atomics, so it is read as bytes and copied field by field.
+    unsigned char headerBytes[sizeof(Header)];
+    if (std::fread(headerBytes, sizeof(headerBytes), 1, file) != 1) {
+        std::fclose(file);
+        error = "the file is shorter than a header";
+        return false;
+    }
+    const Header& raw = *reinterpret_cast<const Header*>(headerBytes);
+    if (raw.magic != kMagic || raw.version != kVersion || raw.headerSize != sizeof(Header)
+        || raw.recordSize != sizeof(Record) || raw.capacity == 0 || (raw.capacity & (raw.capacity - 1)) != 0) {
+        std::fclose(file);
+        error = "not a compatible flight recorder file";
+        return false;
+    }
+    Header& header = out.header;
+    header.magic = raw.magic;
+    header.version = raw.version;
+    header.headerSize = raw.headerSize;
+    header.recordSize = raw.recordSize;
+    header.capacity = raw.capacity;
+    header.processId = raw.processId;
+    header.clockKind = raw.clockKind;
+    header.opened = raw.opened;
+    header.latest[0] = raw.latest[0];
+    header.latest[1] = raw.latest[1];
+    header.latestCount.store(raw.latestCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    header.next.store(raw.next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    std::vector<Record> ring(raw.capacity);
+    const bool read = std::fread(ring.data(), sizeof(Record), ring.size(), file) == ring.size();
+    std::fclose(file);
+    if (!read) {
+        error = "the ring is truncated";
+        return false;
+    }
+
+    // Walk the claimed range oldest first; a slot whose sequence does not match its
+    // index was never finished, or was claimed again by a writer that did not finish.
+    const std::uint64_t next = header.next.load(std::memory_order_relaxed);
+    const std::uint64_t first = next > raw.capacity ? next - raw.capacity : 0;
+    out.overwritten = first;
+    out.torn = 0;
+    out.records.clear();
+    out.records.reserve(static_cast<std::size_t>(next - first));
+    for (std::uint64_t index = first; index < next; ++index) {
+        const Record& record = ring[static_cast<std::size_t>(index & (raw.capacity - 1))];
+        if (record.sequence == static_cast<std::uint32_t>(index + 1)) {
+            out.records.push_back(record);
+        } else {
+            ++out.torn;
+        }
+    }
+
+    out.reference = header.opened;
+    out.nsPerTick = 0.0;
+    if (header.clockKind == ClockKind::SteadyNs) {
+        out.nsPerTick = 1.0;
+    } else {
+        const std::uint64_t count = header.latestCount.load(std::memory_order_relaxed);
+        if (count > 0) {
+            const Calibration& latest = header.latest[(count - 1) & 1];
+            if (latest.ticks > header.opened.ticks && latest.unixNs > header.opened.unixNs) {
+                out.nsPerTick = static_cast<double>(latest.unixNs - header.opened.unixNs)
+                    / static_cast<double>(latest.ticks - header.opened.ticks);
+                out.reference = latest;
+            }
+        }
+    }
+    return true;
+}
+
+std::int64_t unix_ns(const Decoded& decoded, const Record& record) {
+    if (decoded.nsPerTick <= 0.0) {
+        return 0;
+    }
+    const double delta = static_cast<double>(static_cast<std::int64_t>(record.ticks - decoded.reference.ticks));
+    return decoded.reference.unixNs + static_cast<std::int64_t>(delta * decoded.nsPerTick);
+}
+
+} // namespace flight
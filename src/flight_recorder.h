@@ -0,0 +1,180 @@
+#pragma once
+
+// An always-on flight recorder: a fixed-size ring of compact event records in a
+// memory-mapped file. The mapping belongs to the system, which writes its dirty pages
+// back even if the process crashes, so the last events before a crash survive without
+// --verbose and without any write call. (They do not survive a power cut or an OS crash.)
+//
+// Recording claims a slot with one atomic increment, writes 24 bytes and publishes them
+// with a release store of the record's sequence number: no lock and no syscall. Any
+// thread may record. Timestamps are raw CPU time-stamp counter ticks where available;
+// the header keeps (ticks, wall-clock) pairs taken at open and on each calibrate(), from
+// which the decoder recovers wall-clock times.
+//
+// Opening moves the previous run's file aside to PATH.prev, so a restart after a crash
+// does not overwrite the crash's record.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SCREENLIGHT_FLIGHT_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace flight {
+
+constexpr std::uint32_t kMagic = 0x52464C53; // "SLFR" in little-endian memory order.
+constexpr std::uint32_t kVersion = 1;        // Bump on any layout change.
+constexpr std::uint32_t kCapacity = 16384;   // Records in the ring; a power of two.
+static_assert((kCapacity & (kCapacity - 1)) == 0);
+
+enum class Event : std::uint16_t {
+    Start,            // value: process id.
+    Exit,             // value: exit code.
+    KeyDown,          // arg: virtual key, value: modifiers.
+    HotKey,           // arg: hotkey id.
+    Light,            // arg: gray level, value: Kelvin << 8 | sixteenths above the level.
+    Motion,           // arg: 1 if enabled.
+    PowerBroadcast,   // arg: WM_POWERBROADCAST event.
+    SessionChange,    // arg: WM_WTSSESSION_CHANGE event.
+    Schedule,         // arg: 1 if painting and motion are paused, value: motion frame delay in ms.
+    Stall,            // arg: 1 once it ended, value: message << 32 | duration in ms.
+    SettingsReloaded, // No payload.
+    SettingsRejected, // No payload.
+    Footprint,        // value: working set in bytes.
+    ConsoleSignal,    // arg: console control event.
+    WindowDestroyed,  // No payload.
+    AmbientTarget,    // arg: new target gray level, value: readings in the poll that moved it.
+    Throttle,         // arg: governed frame delay in ms, value: CPU usage in permille of one core.
+    Count
+};
+
+// Display names for the decoder, indexed by Event.
+constexpr std::string_view kEventNames[] = {
+    "start",
+    "exit",
+    "key_down",
+    "hotkey",
+    "light",
+    "motion",
+    "power_broadcast",
+    "session_change",
+    "schedule",
+    "stall",
+    "settings_reloaded",
+    "settings_rejected",
+    "footprint",
+    "console_signal",
+    "window_destroyed",
+    "ambient_target",
+    "throttle",
+};
+static_assert(std::size(kEventNames) == static_cast<std::size_t>(Event::Count));
+
+enum class ClockKind : std::uint32_t {
+    SteadyNs, // Ticks are steady_clock nanoseconds.
+    Tsc,      // Ticks are CPU time-stamp counter ticks.
+};
+
+struct Record {
+    std::uint64_t ticks;
+    std::uint64_t value;
+    std::uint32_t sequence; // Claimed index + 1, stored last; anything else means torn or not yet written.
+    std::uint16_t event;
+    std::uint16_t arg;
+};
+static_assert(sizeof(Record) == 24, "Record layout must not change silently");
+
+// A clock reading paired with the wall-clock time it was taken at.
+struct Calibration {
+    std::uint64_t ticks;
+    std::int64_t unixNs;
+};
+
+struct alignas(64) Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t recordSize;
+    std::uint32_t capacity;
+    std::uint32_t processId;
+    ClockKind clockKind;
+    std::uint32_t reserved;
+    Calibration opened;
+    // The latest calibration alternates between two slots; latestCount, stored after
+    // the slot, says which one is complete.
+    Calibration latest[2];
+    std::atomic<std::uint64_t> latestCount;
+    // Records claimed so far; the ring holds the last kCapacity of them.
+    alignas(64) std::atomic<std::uint64_t> next;
+};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The ring must be address-free across processes");
+
+namespace detail {
+    struct Ring {
+        Header* header;
+        Record* records;
+        std::uint64_t mask;
+    };
+    // Always valid: a small process-local ring until open() succeeds, so record()
+    // never checks whether the recorder is open.
+    extern Ring g_ring;
+
+    inline std::uint64_t ticks() {
+#ifdef SCREENLIGHT_FLIGHT_TSC
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+}
+
+// Maps the ring file, moving an existing one to utf8Path + ".prev" first. Call it before
+// other threads record, and close() after they stop. Returns false if the file could not
+// be mapped; records then go to the local ring and are lost at exit.
+bool open(const std::string& utf8Path);
+void close();
+
+// Stores a fresh (ticks, wall-clock) pair so the decoder can convert tick counts. A
+// syscall; call it occasionally from one thread, not per record.
+void calibrate();
+
+inline void record(Event event, std::uint16_t arg = 0, std::uint64_t value = 0) {
+    const detail::Ring& ring = detail::g_ring;
+    const std::uint64_t index = ring.header->next.fetch_add(1, std::memory_order_relaxed);
+    Record& slot = ring.records[index & ring.mask];
+    slot.ticks = detail::ticks();
+    slot.value = value;
+    slot.event = static_cast<std::uint16_t>(event);
+    slot.arg = arg;
+    std::atomic_ref<std::uint32_t>(slot.sequence).store(static_cast<std::uint32_t>(index + 1), std::memory_order_release);
+}
+
+// A decoded ring file, oldest record first.
+struct Decoded {
+    Header header{};
+    std::vector<Record> records;
+    std::uint64_t overwritten = 0; // Older records the ring no longer holds.
+    std::uint64_t torn = 0;        // Claimed records that were never completely written.
+    double nsPerTick = 0.0;        // 0 if the file has no usable calibration.
+    Calibration reference{};       // The calibration times are measured from.
+};
+
+// Reads a ring file on any host. Returns false with a reason if it is not a compatible file.
+bool decode_file(const std::string& utf8Path, Decoded& out, std::string& error);
+
+// The wall-clock time of a decoded record in ns since the Unix epoch, or 0 if unknown.
+std::int64_t unix_ns(const Decoded& decoded, const Record& record);
+
+} // namespace flight
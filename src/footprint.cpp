@@ -0,0 +1,89 @@
+#include "footprint.h"
+
+#include "telemetry.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h> // For GetProcessMemoryInfo
+#else
+#include <cstdio>
+#if defined(__GLIBC__)
+#include <malloc.h> // For malloc_trim
+#endif
+#endif
+
+namespace footprint {
+
+#ifdef _WIN32
+
+Sample take_sample() {
+    Sample sample;
+    PROCESS_MEMORY_COUNTERS_EX counters = {};
+    counters.cb = sizeof(counters);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        sample.privateBytes = counters.PrivateUsage;
+        sample.workingSetBytes = counters.WorkingSetSize;
+    }
+    sample.gdiHandles = GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS);
+    sample.userHandles = GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS);
+    return sample;
+}
+
+bool trim_working_set() {
+    HeapCompact(GetProcessHeap(), 0);
+    // (SIZE_T)-1 for both limits asks the system to remove as many pages as it can.
+    return SetProcessWorkingSetSize(GetCurrentProcess(), static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1)) != FALSE;
+}
+
+#else
+
+// /proc/self/status reports VmRSS (resident) and RssAnon (resident anonymous, the
+// nearest equivalent of private bytes) in kB.
+Sample take_sample() {
+    Sample sample;
+    std::FILE* file = std::fopen("/proc/self/status", "r");
+    if (!file) {
+        return sample;
+    }
+    char line[128];
+    while (std::fgets(line, sizeof(line), file)) {
+        unsigned long long kb = 0;
+        if (std::sscanf(line, "VmRSS: %llu kB", &kb) == 1) {
+            sample.workingSetBytes = kb * 1024;
+        } else if (std::sscanf(line, "RssAnon: %llu kB", &kb) == 1) {
+            sample.privateBytes = kb * 1024;
+        }
+    }
+    std::fclose(file);
+    return sample;
+}
+
+bool trim_working_set() {
+#if defined(__GLIBC__)
+    return malloc_trim(0) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif
+
+void publish(const Sample& sample) {
+    telemetry::set(telemetry::Counter::PrivateBytes, sample.privateBytes);
+    telemetry::set(telemetry::Counter::WorkingSetBytes, sample.workingSetBytes);
+    telemetry::set(telemetry::Counter::GdiHandles, sample.gdiHandles);
+    telemetry::set(telemetry::Counter::UserHandles, sample.userHandles);
+}
+
+void publish_steady(const Sample& sample) {
+    telemetry::set(telemetry::Counter::SteadyWorkingSetBytes, sample.workingSetBytes);
+}
+
+std::string describe(const Sample& sample) {
+    return "private " + std::to_string(sample.privateBytes / 1024) + " KB, working set "
+        + std::to_string(sample.workingSetBytes / 1024) + " KB, "
+        + std::to_string(sample.gdiHandles) + " GDI / " + std::to_string(sample.userHandles) + " USER handles";
+}
+
+} // namespace footprint
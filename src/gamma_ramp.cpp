@@ -0,0 +1,404 @@
+#include "gamma_ramp.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "file_io.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(SCREENLIGHT_HAS_XRANDR)
+#include <X11/Xlib.h>
+#include <X11/extensions/Xrandr.h>
+#endif
+
+namespace gamma_ramp {
+
+namespace {
+    constexpr std::uint32_t kMagic = 0x52474C53; // "SLGR" in little-endian memory order.
+    constexpr std::uint16_t kVersion = 1;
+    constexpr std::size_t kMaxEntries = 65536;
+    constexpr std::size_t kMaxIdLength = 1024;
+
+    // Followed by the id, the red, green and blue tables, and an FNV-1a checksum of
+    // everything before it. Multi-byte fields are in the host's byte order.
+    struct FileHeader {
+        std::uint32_t magic = kMagic;
+        std::uint16_t version = kVersion;
+        std::uint16_t idLength = 0;
+        std::uint32_t entries = 0;
+    };
+    static_assert(sizeof(FileHeader) == 12, "Saved ramp layout must not change silently");
+
+    std::uint32_t checksum_of(const unsigned char* bytes, std::size_t size) {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    void append(std::vector<unsigned char>& out, const void* data, std::size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+#ifdef _WIN32
+    // GDI ramps are always three tables of 256 entries.
+    class GdiDevice final : public Device {
+    public:
+        GdiDevice(HDC dc, std::string id) : m_dc(dc), m_id(std::move(id)) {}
+        ~GdiDevice() override { DeleteDC(m_dc); }
+
+        const std::string& id() const override { return m_id; }
+
+        bool read(Ramp& ramp) override {
+            WORD tables[3][256];
+            if (!GetDeviceGammaRamp(m_dc, tables)) {
+                return false;
+            }
+            ramp.red.assign(tables[0], tables[0] + 256);
+            ramp.green.assign(tables[1], tables[1] + 256);
+            ramp.blue.assign(tables[2], tables[2] + 256);
+            return true;
+        }
+
+        bool write(const Ramp& ramp) override {
+            if (ramp.size() != 256) {
+                return false;
+            }
+            WORD tables[3][256];
+            std::copy(ramp.red.begin(), ramp.red.end(), tables[0]);
+            std::copy(ramp.green.begin(), ramp.green.end(), tables[1]);
+            std::copy(ramp.blue.begin(), ramp.blue.end(), tables[2]);
+            return SetDeviceGammaRamp(m_dc, tables) != FALSE;
+        }
+
+    private:
+        HDC m_dc;
+        std::string m_id;
+    };
+#elif defined(SCREENLIGHT_HAS_XRANDR)
+    class RandrDevice final : public Device {
+    public:
+        RandrDevice(Display* display, RRCrtc crtc, int size)
+            : m_display(display), m_crtc(crtc), m_size(size), m_id("x11:" + std::to_string(crtc)) {}
+        ~RandrDevice() override { XCloseDisplay(m_display); }
+
+        const std::string& id() const override { return m_id; }
+
+        bool read(Ramp& ramp) override {
+            XRRCrtcGamma* gamma = XRRGetCrtcGamma(m_display, m_crtc);
+            if (!gamma) {
+                return false;
+            }
+            const bool ok = gamma->size == m_size;
+            if (ok) {
+                ramp.red.assign(gamma->red, gamma->red + m_size);
+                ramp.green.assign(gamma->green, gamma->green + m_size);
+                ramp.blue.assign(gamma->blue, gamma->blue + m_size);
+            }
+            XRRFreeGamma(gamma);
+            return ok;
+        }
+
+        bool write(const Ramp& ramp) override {
+            if (ramp.size() != static_cast<std::size_t>(m_size)) {
+                return false;
+            }
+            XRRCrtcGamma* gamma = XRRAllocGamma(m_size);
+            if (!gamma) {
+                return false;
+            }
+            std::copy(ramp.red.begin(), ramp.red.end(), gamma->red);
+            std::copy(ramp.green.begin(), ramp.green.end(), gamma->green);
+            std::copy(ramp.blue.begin(), ramp.blue.end(), gamma->blue);
+            XRRSetCrtcGamma(m_display, m_crtc, gamma);
+            XRRFreeGamma(gamma);
+            // Errors arrive asynchronously; wait for the server so the change has landed.
+            XSync(m_display, False);
+            return true;
+        }
+
+    private:
+        Display* m_display;
+        RRCrtc m_crtc;
+        int m_size;
+        std::string m_id;
+    };
+
+    // The CRTC driving the primary output, or else the first one with a mode set.
+    RRCrtc primary_crtc(Display* display, Window root, XRRScreenResources* resources) {
+        RRCrtc crtc = None;
+        if (const RROutput primary = XRRGetOutputPrimary(display, root)) {
+            if (XRROutputInfo* output = XRRGetOutputInfo(display, resources, primary)) {
+                crtc = output->crtc;
+                XRRFreeOutputInfo(output);
+            }
+        }
+        for (int i = 0; crtc == None && i < resources->ncrtc; ++i) {
+            if (XRRCrtcInfo* info = XRRGetCrtcInfo(display, resources, resources->crtcs[i])) {
+                if (info->mode != None) crtc = resources->crtcs[i];
+                XRRFreeCrtcInfo(info);
+            }
+        }
+        return crtc;
+    }
+#endif
+}
+
+void scale(const Ramp& original, const core::Light& light, Ramp& out) {
+    out.resize(original.size());
+    // Channel weights in sixteenths of a level: the colour one level up covers fraction of them.
+    const auto weight = [&](std::uint8_t base, std::uint8_t next) {
+        return static_cast<std::uint32_t>(std::max(base * 16 + (next - base) * light.fraction, 0));
+    };
+    const auto apply = [](const std::vector<std::uint16_t>& from, std::vector<std::uint16_t>& to, std::uint32_t weight) {
+        for (std::size_t i = 0; i < from.size(); ++i) {
+            to[i] = static_cast<std::uint16_t>((from[i] * weight + 255 * 8) / (255 * 16));
+        }
+    };
+    apply(original.red, out.red, weight(light.rgb.r, light.next.r));
+    apply(original.green, out.green, weight(light.rgb.g, light.next.g));
+    apply(original.blue, out.blue, weight(light.rgb.b, light.next.b));
+}
+
+std::unique_ptr<Device> open_device([[maybe_unused]] std::string_view id, std::string& error) {
+#ifdef _WIN32
+    std::wstring name = file_io::widen(id);
+    if (name.empty()) {
+        DISPLAY_DEVICEW device = {};
+        device.cb = sizeof(device);
+        for (DWORD i = 0; name.empty() && EnumDisplayDevicesW(NULL, i, &device, 0); ++i) {
+            if (device.StateFlags & DISPLAY_DEVICE_PRIMARY_DEVICE) name = device.DeviceName;
+        }
+    }
+    HDC dc = name.empty() ? NULL : CreateDCW(NULL, name.c_str(), NULL, NULL);
+    if (!dc) {
+        error = "no display device " + (id.empty() ? std::string("for the primary monitor") : std::string(id));
+        return nullptr;
+    }
+    return std::make_unique<GdiDevice>(dc, file_io::narrow(name));
+#elif defined(SCREENLIGHT_HAS_XRANDR)
+    RRCrtc wanted = None;
+    if (!id.empty()) {
+        constexpr std::string_view prefix = "x11:";
+        unsigned long value = 0;
+        bool ok = id.starts_with(prefix) && id.size() > prefix.size();
+        for (const char c : id.substr(prefix.size())) {
+            ok = ok && c >= '0' && c <= '9';
+            value = value * 10 + static_cast<unsigned long>(c - '0');
+        }
+        if (!ok) {
+            error = "expected x11:CRTC, not " + std::string(id);
+            return nullptr;
+        }
+        wanted = static_cast<RRCrtc>(value);
+    }
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        error = "cannot open the X display";
+        return nullptr;
+    }
+    int eventBase = 0, errorBase = 0, major = 0, minor = 0;
+    if (!XRRQueryExtension(display, &eventBase, &errorBase) || !XRRQueryVersion(display, &major, &minor)
+        || (major == 1 && minor < 2)) {
+        XCloseDisplay(display);
+        error = "the X server has no RandR 1.2 CRTC gamma";
+        return nullptr;
+    }
+    const Window root = DefaultRootWindow(display);
+    XRRScreenResources* resources = XRRGetScreenResourcesCurrent(display, root);
+    RRCrtc crtc = None;
+    if (resources) {
+        RRCrtc* const end = resources->crtcs + resources->ncrtc;
+        if (wanted == None) {
+            crtc = primary_crtc(display, root, resources);
+        } else if (std::find(resources->crtcs, end, wanted) != end) {
+            crtc = wanted;
+        }
+        XRRFreeScreenResources(resources);
+    }
+    const int size = crtc != None ? XRRGetCrtcGammaSize(display, crtc) : 0;
+    if (size <= 0) {
+        XCloseDisplay(display);
+        error = crtc == None ? "no such CRTC" : "the CRTC has no gamma ramp";
+        return nullptr;
+    }
+    return std::make_unique<RandrDevice>(display, crtc, size);
+#else
+    error = "built without X11 RandR support";
+    return nullptr;
+#endif
+}
+
+bool save_original(const std::string& utf8Path, const std::string& id, const Ramp& ramp) {
+    if (id.size() > kMaxIdLength || ramp.size() == 0 || ramp.size() > kMaxEntries) {
+        return false;
+    }
+    FileHeader header;
+    header.idLength = static_cast<std::uint16_t>(id.size());
+    header.entries = static_cast<std::uint32_t>(ramp.size());
+    std::vector<unsigned char> image;
+    image.reserve(sizeof(header) + id.size() + ramp.size() * 6 + 4);
+    append(image, &header, sizeof(header));
+    append(image, id.data(), id.size());
+    append(image, ramp.red.data(), ramp.size() * 2);
+    append(image, ramp.green.data(), ramp.size() * 2);
+    append(image, ramp.blue.data(), ramp.size() * 2);
+    const std::uint32_t checksum = checksum_of(image.data(), image.size());
+    append(image, &checksum, sizeof(checksum));
+
+    std::FILE* file = file_io::open_file(utf8Path, true);
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(image.data(), image.size(), 1, file) == 1;
+    if (std::fclose(file) != 0 || !written) {
+        file_io::remove_file(utf8Path);
+        return false;
+    }
+    return true;
+}
+
+bool load_original(const std::string& utf8Path, std::string& id, Ramp& ramp) {
+    std::FILE* file = file_io::open_file(utf8Path, false);
+    if (!file) {
+        return false;
+    }
+    std::vector<unsigned char> image;
+    unsigned char buffer[16384];
+    std::size_t read = 0;
+    constexpr std::size_t kMaxSize = sizeof(FileHeader) + kMaxIdLength + kMaxEntries * 6 + 4;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0 && image.size() <= kMaxSize) {
+        image.insert(image.end(), buffer, buffer + read);
+    }
+    std::fclose(file);
+
+    FileHeader header;
+    if (image.size() < sizeof(header) + 4) {
+        return false;
+    }
+    std::memcpy(&header, image.data(), sizeof(header));
+    const std::size_t tableBytes = static_cast<std::size_t>(header.entries) * 2;
+    const std::size_t expected = sizeof(header) + header.idLength + tableBytes * 3 + 4;
+    if (header.magic != kMagic || header.version != kVersion || header.entries == 0 || header.entries > kMaxEntries
+        || header.idLength > kMaxIdLength || image.size() != expected) {
+        return false;
+    }
+    std::uint32_t checksum = 0;
+    std::memcpy(&checksum, image.data() + expected - 4, sizeof(checksum));
+    if (checksum != checksum_of(image.data(), expected - 4)) {
+        return false;
+    }
+    const unsigned char* at = image.data() + sizeof(header);
+    id.assign(reinterpret_cast<const char*>(at), header.idLength);
+    at += header.idLength;
+    ramp.resize(header.entries);
+    std::memcpy(ramp.red.data(), at, tableBytes);
+    std::memcpy(ramp.green.data(), at + tableBytes, tableBytes);
+    std::memcpy(ramp.blue.data(), at + tableBytes * 2, tableBytes);
+    return true;
+}
+
+RecoverResult recover(const std::string& utf8Path, std::string& error) {
+    std::FILE* probe = file_io::open_file(utf8Path, false);
+    if (!probe) {
+        return RecoverResult::Nothing;
+    }
+    std::fclose(probe);
+    std::string id;
+    Ramp ramp;
+    if (!load_original(utf8Path, id, ramp)) {
+        // Nothing in it can be trusted, and keeping it would fail every later start too.
+        file_io::remove_file(utf8Path);
+        error = "the saved ramp in " + utf8Path + " is unreadable";
+        return RecoverResult::Failed;
+    }
+    // If the output is gone the file is kept, so a run with it connected can still restore it.
+    const std::unique_ptr<Device> device = open_device(id, error);
+    if (!device) {
+        return RecoverResult::Failed;
+    }
+    if (!device->write(ramp)) {
+        error = "the display refused the saved ramp of " + id;
+        return RecoverResult::Failed;
+    }
+    file_io::remove_file(utf8Path);
+    return RecoverResult::Restored;
+}
+
+bool Driver::start(std::unique_ptr<Device> device, const std::string& savedPath, std::string& error) {
+    restore();
+    if (!device) {
+        return false; // open_device has already said why.
+    }
+    Ramp original;
+    if (!device->read(original) || original.size() == 0) {
+        error = "cannot read the gamma ramp of " + device->id();
+        return false;
+    }
+    if (!save_original(savedPath, device->id(), original)) {
+        error = "cannot save the original ramp to " + savedPath;
+        return false;
+    }
+    m_device = std::move(device);
+    m_savedPath = savedPath;
+    m_current = original;
+    m_original = std::move(original);
+    m_showing = false;
+    return true;
+}
+
+bool Driver::upload(const Ramp& ramp) {
+    if (!m_device->write(ramp)) {
+        return false;
+    }
+    ++m_uploads;
+    return true;
+}
+
+bool Driver::show(const core::Light& light) {
+    if (!m_device) {
+        return false;
+    }
+    Ramp next;
+    scale(m_original, light, next);
+    if (m_showing && next == m_current) {
+        return true;
+    }
+    if (upload(next)) {
+        m_current = std::move(next);
+        m_showing = true;
+        return true;
+    }
+    // Refused: the painted light needs the original ramp under it.
+    if (m_current != m_original) {
+        upload(m_original);
+        m_current = m_original;
+    }
+    m_showing = false;
+    return false;
+}
+
+void Driver::reapply() {
+    if (m_device) {
+        upload(m_current);
+    }
+}
+
+void Driver::restore() {
+    if (!m_device) {
+        return;
+    }
+    // Keep the saved file if the original could not be written, so the next run retries.
+    if (m_device->write(m_original)) {
+        file_io::remove_file(m_savedPath);
+    }
+    m_device.reset();
+    m_showing = false;
+}
+
+} // namespace gamma_ramp
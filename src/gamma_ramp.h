@@ -0,0 +1,109 @@
+#pragma once
+
+// Brightness and colour temperature through the display's gamma ramp. With --gamma-ramp
+// the surface stays full white and each light is shown by scaling the output's own
+// ramp per channel, so a level change is one small table upload instead of a repaint
+// of the whole surface. Scaling the original ramp keeps any calibration it carried.
+//
+// The ramp outlives the process, so the original is also saved to a file before the
+// first change. A run that crashed or was killed leaves that file behind, and the next
+// run puts the original back from it (recover).
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "light_core.h"
+
+namespace gamma_ramp {
+
+// One 16-bit table per channel, mapping each input level to an output level. Windows
+// ramps have 256 entries; an X11 CRTC has its own gamma size.
+struct Ramp {
+    std::vector<std::uint16_t> red;
+    std::vector<std::uint16_t> green;
+    std::vector<std::uint16_t> blue;
+
+    void resize(std::size_t entries) {
+        red.resize(entries);
+        green.resize(entries);
+        blue.resize(entries);
+    }
+    [[nodiscard]] std::size_t size() const { return red.size(); }
+
+    bool operator==(const Ramp&) const = default;
+};
+
+// The original ramp scaled by the light's colour. A dithered light's fraction is applied
+// exactly, since the ramp has far finer steps than a gray level.
+void scale(const Ramp& original, const core::Light& light, Ramp& out);
+
+// A display output whose ramp can be read and written.
+class Device {
+public:
+    virtual ~Device() = default;
+    // Names the output, so a ramp saved for it can be written back to it by a later run.
+    [[nodiscard]] virtual const std::string& id() const = 0;
+    virtual bool read(Ramp& ramp) = 0;
+    virtual bool write(const Ramp& ramp) = 0;
+};
+
+// Opens an output by id: a Windows display device name such as \\.\DISPLAY1, or
+// "x11:CRTC" for an X11 RandR CRTC on $DISPLAY. An empty id opens the primary output.
+// Returns nullptr with a reason if there is no such output or it has no gamma ramp.
+std::unique_ptr<Device> open_device(std::string_view id, std::string& error);
+
+// The saved original ramp of an output. Written before the first change, removed once
+// the original is back.
+bool save_original(const std::string& utf8Path, const std::string& id, const Ramp& ramp);
+bool load_original(const std::string& utf8Path, std::string& id, Ramp& ramp);
+
+enum class RecoverResult {
+    Nothing,  // No saved ramp: the last run exited cleanly.
+    Restored, // A saved ramp was written back and its file removed.
+    Failed,   // A saved ramp could not be written back; error says why.
+};
+
+// Writes back a ramp left saved by a run that did not exit cleanly.
+RecoverResult recover(const std::string& utf8Path, std::string& error);
+
+// Drives one output's ramp for the application.
+class Driver {
+public:
+    Driver() = default;
+    Driver(const Driver&) = delete;
+    Driver& operator=(const Driver&) = delete;
+    ~Driver() { restore(); }
+
+    // Takes over the device's ramp. Fails, changing nothing, if there is no device, its
+    // ramp cannot be read or the original cannot be saved to savedPath.
+    bool start(std::unique_ptr<Device> device, const std::string& savedPath, std::string& error);
+
+    // Shows the light through the ramp. Returns false if the device refused the ramp
+    // (Windows rejects ramps far from identity); the original is then in place, and the
+    // caller paints the light instead.
+    bool show(const core::Light& light);
+    // Writes the current ramp again, e.g. after a display mode change reset it.
+    void reapply();
+    // Puts the original ramp back, removes the saved file and releases the device.
+    void restore();
+
+    [[nodiscard]] bool is_active() const { return m_device != nullptr; }
+    // Whether the last show() succeeded, i.e. the ramp carries the light and not the surface.
+    [[nodiscard]] bool is_showing() const { return m_device && m_showing; }
+    [[nodiscard]] std::uint64_t upload_count() const { return m_uploads; }
+
+private:
+    bool upload(const Ramp& ramp);
+
+    std::unique_ptr<Device> m_device;
+    std::string m_savedPath;
+    Ramp m_original;
+    Ramp m_current;
+    bool m_showing = false;
+    std::uint64_t m_uploads = 0;
+};
+
+} // namespace gamma_ramp
@@ -0,0 +1,123 @@
+#pragma once
+
+// A core::Backend that renders into an in-memory surface instead of a window, so the
+// core can be driven on any host: by the replay harness, by benchmarks and as the
+// training workload for optimized builds. Painting fills the same pixels the real
+// window would (the whole surface, or only the border band in edge-light mode), with
+// the dither tile between two levels. Every change the core presents invalidates the
+// surface, as it would the window, so callers can paint only when something changed.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "dither.h"
+#include "light_core.h"
+#include "mouse_mover.h"
+
+class HeadlessBackend final : public core::Backend {
+public:
+    HeadlessBackend(int width, int height, bool edgeLight, int grayLevel, int edgeBandWidth,
+                    int kelvin = config::kNeutralKelvin)
+        : m_width(width),
+          m_height(height),
+          m_edgeLight(edgeLight),
+          m_bandWidth(edgeBandWidth),
+          m_surface(static_cast<std::size_t>(width) * static_cast<std::size_t>(height)) {
+        // Counts as the first invalidation, as showing a new window does.
+        const color::Rgb rgb = color::light_color(grayLevel, kelvin);
+        set_light({grayLevel, 0, kelvin, rgb, rgb});
+    }
+
+    void set_light(const core::Light& light) override {
+        m_pixel = dither::pack(light.rgb);
+        m_dithered = light.fraction != 0;
+        if (m_dithered) {
+            m_tile = dither::make_tile(m_pixel, dither::pack(light.next), light.fraction);
+        }
+        invalidate();
+    }
+
+    void set_edge_band_width(int width) override {
+        m_bandWidth = width;
+        ++m_regionUpdates;
+        invalidate();
+    }
+
+    void set_motion_enabled(bool enabled) override { m_motionEnabled = enabled; }
+    void request_quit() override { m_quitRequested = true; }
+
+    // Emulates WM_PAINT with the class brush: fills the visible part of the surface and
+    // validates it.
+    void paint() {
+        ++m_repaints;
+        m_invalid = false;
+        if (!m_edgeLight) {
+            if (m_dithered) {
+                dither::fill(m_surface.data(), m_width, m_height, m_width, m_tile);
+            } else {
+                std::fill(m_surface.begin(), m_surface.end(), m_pixel);
+            }
+            return;
+        }
+        const int band = std::min(m_bandWidth, std::min(m_width, m_height) / 2);
+        for (int y = 0; y < m_height; ++y) {
+            std::uint32_t* row = m_surface.data() + static_cast<std::size_t>(y) * m_width;
+            if (y < band || y >= m_height - band) {
+                fill_span(row, 0, m_width, y);
+            } else {
+                fill_span(row, 0, band, y);
+                fill_span(row, m_width - band, band, y);
+            }
+        }
+    }
+
+    // Emulates SetCursorPos.
+    void move_cursor(CursorPoint point) {
+        m_cursor = point;
+        ++m_cursorMoves;
+    }
+
+    [[nodiscard]] bool motion_enabled() const { return m_motionEnabled; }
+    [[nodiscard]] bool quit_requested() const { return m_quitRequested; }
+    // True if the core changed something since the last paint.
+    [[nodiscard]] bool is_invalid() const { return m_invalid; }
+    [[nodiscard]] std::uint64_t invalidations() const { return m_invalidations; }
+    [[nodiscard]] std::uint64_t repaints() const { return m_repaints; }
+    [[nodiscard]] std::uint64_t cursor_moves() const { return m_cursorMoves; }
+    [[nodiscard]] std::uint64_t region_updates() const { return m_regionUpdates; }
+    [[nodiscard]] CursorPoint cursor() const { return m_cursor; }
+    [[nodiscard]] std::uint32_t pixel_at(int x, int y) const { return m_surface[static_cast<std::size_t>(y) * m_width + x]; }
+
+private:
+    void invalidate() {
+        m_invalid = true;
+        ++m_invalidations;
+    }
+
+    void fill_span(std::uint32_t* row, int x, int count, int y) const {
+        if (m_dithered) {
+            dither::fill_span(row, x, count, y, m_tile);
+        } else {
+            std::fill(row + x, row + x + count, m_pixel);
+        }
+    }
+
+    int m_width;
+    int m_height;
+    bool m_edgeLight;
+    int m_bandWidth;
+    std::vector<std::uint32_t> m_surface;
+    std::uint32_t m_pixel = 0;
+    bool m_dithered = false;
+    dither::Tile m_tile{};
+    bool m_motionEnabled = true;
+    bool m_quitRequested = false;
+    CursorPoint m_cursor{0, 0};
+    bool m_invalid = false;
+    std::uint64_t m_invalidations = 0;
+    std::uint64_t m_repaints = 0;
+    std::uint64_t m_cursorMoves = 0;
+    std::uint64_t m_regionUpdates = 0;
+};
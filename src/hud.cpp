@@ -0,0 +1,197 @@
+#include "hud.h"
+
+#include <algorithm>
+
+namespace {
+    constexpr COLORREF kPanelColor = RGB(32, 32, 32);
+    constexpr COLORREF kTextColor = RGB(255, 255, 255);
+
+    // Atlas entries after the digits, in Glyph order.
+    constexpr const wchar_t* kLabels[] = {L"Light  ", L"Edge light  ", L"   Motion on", L"   Motion off", L"K", L"   "};
+
+    BYTE lerp(BYTE from, BYTE to, int step, int steps) {
+        return static_cast<BYTE>(from + (to - from) * step / steps);
+    }
+}
+
+bool Hud::create(HWND hwnd, timeline::Scheduler& scheduler) {
+    destroy();
+    m_hwnd = hwnd;
+    m_scheduler = &scheduler;
+
+    HDC windowDC = GetDC(hwnd);
+    m_atlasDC = CreateCompatibleDC(windowDC);
+    ReleaseDC(hwnd, windowDC);
+    // Non-antialiased text keeps the atlas strictly two-tone, so a monochrome bitmap
+    // holds it and BitBlt maps its bits to the DC's text and background colours.
+    HFONT font = CreateFontW(-28, 0, 0, 0, FW_SEMIBOLD, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS,
+                             CLIP_DEFAULT_PRECIS, NONANTIALIASED_QUALITY, DEFAULT_PITCH | FF_SWISS, L"Segoe UI");
+    if (!m_atlasDC || !font) {
+        if (font) DeleteObject(font);
+        destroy();
+        return false;
+    }
+    HGDIOBJ previousFont = SelectObject(m_atlasDC, font);
+
+    // Measure every cell, then render them side by side in one row.
+    wchar_t digit[2] = {};
+    auto glyph_text = [&](int glyph) -> const wchar_t* {
+        if (glyph < kGlyphLabelLight) {
+            digit[0] = static_cast<wchar_t>(L'0' + glyph);
+            return digit;
+        }
+        return kLabels[glyph - kGlyphLabelLight];
+    };
+    int x = 0;
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        const wchar_t* text = glyph_text(glyph);
+        SIZE size = {};
+        GetTextExtentPoint32W(m_atlasDC, text, lstrlenW(text), &size);
+        m_glyphX[glyph] = x;
+        x += size.cx;
+        m_glyphHeight = std::max(m_glyphHeight, static_cast<int>(size.cy));
+    }
+    m_glyphX[kGlyphCount] = x;
+
+    m_atlas = CreateBitmap(x, m_glyphHeight, 1, 1, NULL);
+    if (!m_atlas) {
+        SelectObject(m_atlasDC, previousFont);
+        DeleteObject(font);
+        destroy();
+        return false;
+    }
+    m_previousBitmap = SelectObject(m_atlasDC, m_atlas);
+    // In a monochrome DC black is 0 and white is 1; a colour blit turns 0 bits into the
+    // destination's text colour and 1 bits into its background colour.
+    SetTextColor(m_atlasDC, RGB(0, 0, 0));
+    SetBkColor(m_atlasDC, RGB(255, 255, 255));
+    SetBkMode(m_atlasDC, OPAQUE);
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        const wchar_t* text = glyph_text(glyph);
+        TextOutW(m_atlasDC, m_glyphX[glyph], 0, text, lstrlenW(text));
+    }
+
+    // The font is only needed to render the atlas.
+    SelectObject(m_atlasDC, previousFont);
+    DeleteObject(font);
+    return true;
+}
+
+void Hud::destroy() {
+    if (m_scheduler) {
+        m_scheduler->cancel(m_fadeTask);
+    }
+    m_visible = false;
+    if (m_atlasDC) {
+        if (m_previousBitmap) SelectObject(m_atlasDC, m_previousBitmap);
+        DeleteDC(m_atlasDC);
+    }
+    if (m_atlas) DeleteObject(m_atlas);
+    m_atlasDC = NULL;
+    m_atlas = NULL;
+    m_previousBitmap = NULL;
+}
+
+void Hud::show(const core::State& state, bool surfaceWhite) {
+    if (!m_atlas) {
+        return;
+    }
+    // Compose the line as atlas cells: mode, level, temperature unless neutral, motion.
+    int length = 0;
+    auto append_number = [&](int value) {
+        Glyph digits[5];
+        int count = 0;
+        do {
+            digits[count++] = static_cast<Glyph>(kGlyphDigit0 + value % 10);
+            value /= 10;
+        } while (value > 0 && count < 5);
+        while (count > 0) m_run[length++] = digits[--count];
+    };
+    m_run[length++] = state.edgeLight ? kGlyphLabelEdge : kGlyphLabelLight;
+    const int level = std::clamp(state.grayLevel, 0, 255);
+    append_number(level);
+    if (state.kelvin != config::kNeutralKelvin) {
+        m_run[length++] = kGlyphLabelGap;
+        append_number(state.kelvin);
+        m_run[length++] = kGlyphLabelKelvin;
+    }
+    m_run[length++] = state.motionEnabled ? kGlyphLabelMotionOn : kGlyphLabelMotionOff;
+    m_runLength = length;
+    const color::Rgb light = surfaceWhite ? color::Rgb{255, 255, 255} : color::light_color(level, state.kelvin);
+    m_background = RGB(light.r, light.g, light.b);
+
+    int width = 0;
+    for (int i = 0; i < m_runLength; ++i) {
+        width += m_glyphX[m_run[i] + 1] - m_glyphX[m_run[i]];
+    }
+    // Bottom centre of the surface; in edge-light mode, centred in the bottom band.
+    const int panelWidth = width + 2 * kPadding;
+    const int panelHeight = m_glyphHeight + kPadding;
+    const int bottomMargin = state.edgeLight ? std::max((state.edgeBandWidth - panelHeight) / 2, 0) : 48;
+    const int left = (state.surfaceWidth - panelWidth) / 2;
+    const int top = state.surfaceHeight - bottomMargin - panelHeight;
+    const RECT previous = m_rect;
+    const bool wasVisible = m_visible;
+    m_rect = {left, top, left + panelWidth, top + panelHeight};
+
+    m_visible = true;
+    m_fadeStep = 0;
+    m_scheduler->cancel(m_fadeTask);
+    m_fadeTask = m_scheduler->spawn(hold_and_fade());
+    // A narrower line leaves part of the old panel behind, which only an erase removes.
+    if (wasVisible && (previous.left != m_rect.left || previous.top != m_rect.top)) {
+        InvalidateRect(m_hwnd, &previous, TRUE);
+    }
+    invalidate(false);
+}
+
+// Holds, then steps the fade, then lets the background erase take the area back.
+timeline::Task Hud::hold_and_fade() {
+    co_await m_scheduler->after(kHold);
+    const int stride = static_cast<int>((std::max(m_minFrameDelay, kFadeStep) + kFadeStep - std::chrono::milliseconds(1)) / kFadeStep);
+    for (m_fadeStep = stride; m_fadeStep < kFadeSteps; m_fadeStep += stride) {
+        invalidate(false);
+        co_await m_scheduler->after(kFadeStep * stride);
+    }
+    m_visible = false;
+    invalidate(true);
+}
+
+void Hud::exclude_from(HDC hdc) const {
+    if (m_visible) {
+        ExcludeClipRect(hdc, m_rect.left, m_rect.top, m_rect.right, m_rect.bottom);
+    }
+}
+
+COLORREF Hud::fade_towards_background(COLORREF color) const {
+    return RGB(lerp(GetRValue(color), GetRValue(m_background), m_fadeStep, kFadeSteps),
+               lerp(GetGValue(color), GetGValue(m_background), m_fadeStep, kFadeSteps),
+               lerp(GetBValue(color), GetBValue(m_background), m_fadeStep, kFadeSteps));
+}
+
+void Hud::paint(HDC hdc, const RECT& updateRect) const {
+    RECT overlap;
+    if (!m_visible || !IntersectRect(&overlap, &m_rect, &updateRect)) {
+        return;
+    }
+    const COLORREF panel = fade_towards_background(kPanelColor);
+    // The panel padding. ExtTextOut with ETO_OPAQUE fills a rectangle with the
+    // background colour without creating a brush.
+    SetBkColor(hdc, panel);
+    ExtTextOutW(hdc, 0, 0, ETO_OPAQUE, &m_rect, NULL, 0, NULL);
+
+    // The glyph cells, coloured by the DC.
+    SetTextColor(hdc, fade_towards_background(kTextColor));
+    int x = m_rect.left + kPadding;
+    const int y = m_rect.top + kPadding / 2;
+    for (int i = 0; i < m_runLength; ++i) {
+        const int cellX = m_glyphX[m_run[i]];
+        const int cellWidth = m_glyphX[m_run[i] + 1] - cellX;
+        BitBlt(hdc, x, y, cellWidth, m_glyphHeight, m_atlasDC, cellX, 0, SRCCOPY);
+        x += cellWidth;
+    }
+}
+
+void Hud::invalidate(bool erase) const {
+    InvalidateRect(m_hwnd, &m_rect, erase ? TRUE : FALSE);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+// A small on-screen display of the brightness level and mode, shown after each
+// adjustment and faded out shortly after. Every digit and label is rendered once, at
+// creation, into a monochrome glyph atlas; showing or fading the HUD only BitBlts atlas
+// cells into the HUD's own rectangle, with the colours carried by the DC. Nothing
+// touches fonts or text layout after creation.
+//
+// Timing is one task on the timeline: a hold period, then a few fade steps. The task
+// ends as soon as the HUD is hidden, so an idle HUD waits on nothing.
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "light_core.h" // For core::State
+#include "timeline.h"
+
+class Hud {
+public:
+    Hud() = default;
+    Hud(const Hud&) = delete;
+    Hud& operator=(const Hud&) = delete;
+    ~Hud() { destroy(); }
+
+    // Renders the atlas for the window. The hold and fade run on the given timeline.
+    bool create(HWND hwnd, timeline::Scheduler& scheduler);
+    void destroy();
+
+    // Shows the HUD for the given state, restarting the hold period. It fades into the
+    // state's light colour, or into white when the surface is painted white because the
+    // gamma ramp shows the light.
+    void show(const core::State& state, bool surfaceWhite = false);
+
+    // The shortest time between two fade frames, raised by the CPU governor. The fade
+    // keeps its length and skips frames instead.
+    void set_min_frame_delay(std::chrono::milliseconds delay) { m_minFrameDelay = delay; }
+
+    // Keeps the background erase off the HUD, so it is not painted twice per frame.
+    // The caller restores the DC's clip before painting.
+    void exclude_from(HDC hdc) const;
+    // Draws the HUD if it is visible and inside the paint's update rectangle.
+    void paint(HDC hdc, const RECT& updateRect) const;
+
+    [[nodiscard]] bool is_visible() const { return m_visible; }
+
+private:
+    enum Glyph {
+        kGlyphDigit0,
+        kGlyphLabelLight = kGlyphDigit0 + 10,
+        kGlyphLabelEdge,
+        kGlyphLabelMotionOn,
+        kGlyphLabelMotionOff,
+        kGlyphLabelKelvin,
+        kGlyphLabelGap,
+        kGlyphCount,
+    };
+    static constexpr int kMaxRun = 16;      // Glyphs in one HUD line.
+    static constexpr int kPadding = 12;     // Panel margin around the text, in pixels.
+    static constexpr int kFadeSteps = 8;
+    static constexpr std::chrono::milliseconds kHold{1500};
+    static constexpr std::chrono::milliseconds kFadeStep{50};
+
+    timeline::Task hold_and_fade();
+    [[nodiscard]] COLORREF fade_towards_background(COLORREF color) const;
+    void invalidate(bool erase) const;
+
+    HWND m_hwnd = NULL;
+    timeline::Scheduler* m_scheduler = nullptr;
+    timeline::TaskId m_fadeTask = 0;
+    std::chrono::milliseconds m_minFrameDelay{0};
+    HDC m_atlasDC = NULL;
+    HBITMAP m_atlas = NULL;
+    HGDIOBJ m_previousBitmap = NULL;
+    int m_glyphX[kGlyphCount + 1] = {}; // Left edge of each cell; the last entry is the atlas width.
+    int m_glyphHeight = 0;
+
+    Glyph m_run[kMaxRun] = {};
+    int m_runLength = 0;
+    RECT m_rect = {};
+    bool m_visible = false;
+    int m_fadeStep = 0; // 0 while holding, kFadeSteps when fully faded.
+    COLORREF m_background = RGB(255, 255, 255);
+};
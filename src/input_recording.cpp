@@ -0,0 +1,73 @@
+#include "input_recording.h"
+
+#include <algorithm>
+
+#include "file_io.h"
+
+namespace recording {
+
+namespace {
+    constexpr std::size_t kWriteBufferSize = 64 * 1024;
+}
+
+bool Recorder::open(const std::string& utf8Path, const FileHeader& header) {
+    close();
+    m_file = file_io::open_file(utf8Path, true);
+    if (!m_file) {
+        return false;
+    }
+    std::setvbuf(m_file, nullptr, _IOFBF, kWriteBufferSize);
+    if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+        close();
+        return false;
+    }
+    m_last = std::chrono::steady_clock::now();
+    return true;
+}
+
+void Recorder::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void Recorder::record(std::uint32_t message, std::uint64_t wParam, std::uint16_t modifiers,
+                      std::chrono::steady_clock::time_point now) {
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - m_last).count();
+    m_last = now;
+    const Event event{
+        static_cast<std::uint32_t>(std::clamp<long long>(delta, 0, UINT32_MAX)),
+        static_cast<std::uint16_t>(message),
+        modifiers,
+        static_cast<std::uint32_t>(wParam),
+    };
+    std::fwrite(&event, sizeof(event), 1, m_file);
+}
+
+bool Reader::open(const std::string& utf8Path, FileHeader& header) {
+    close();
+    m_file = file_io::open_file(utf8Path, false);
+    if (!m_file) {
+        return false;
+    }
+    if (std::fread(&header, sizeof(header), 1, m_file) != 1
+        || header.magic != kMagic || header.version != kVersion || header.headerSize != sizeof(FileHeader)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void Reader::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool Reader::next(Event& event) {
+    return m_file && std::fread(&event, sizeof(event), 1, m_file) == 1;
+}
+
+} // namespace recording
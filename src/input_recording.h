@@ -0,0 +1,79 @@
+#pragma once
+
+// Compact binary recordings of the message stream the window procedure receives,
+// used to reproduce field reports and as a replayable workload. A recording is a
+// FileHeader describing the starting state followed by fixed 12-byte Events.
+// Multi-byte fields are stored in the host's (little-endian) byte order.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace recording {
+
+constexpr std::uint32_t kMagic = 0x43524C53; // "SLRC" in little-endian memory order.
+constexpr std::uint16_t kVersion = 1;
+
+struct FileHeader {
+    std::uint32_t magic = kMagic;
+    std::uint16_t version = kVersion;
+    std::uint16_t headerSize = sizeof(FileHeader);
+    std::uint32_t frameDelayMs = 0;
+    std::uint32_t surfaceWidth = 0;
+    std::uint32_t surfaceHeight = 0;
+    std::int32_t grayLevel = 0;
+    std::int32_t edgeBandWidth = 0;
+    std::uint8_t edgeLight = 0;
+    std::uint8_t motionEnabled = 0;
+    std::uint16_t kelvin = 0; // Colour temperature; 0 (recordings before it existed) is neutral.
+};
+static_assert(sizeof(FileHeader) == 32, "Recording header layout must not change silently");
+
+struct Event {
+    std::uint32_t deltaUs;   // Time since the previous event, saturated at ~71 minutes.
+    std::uint16_t message;   // Window message; all system and registered messages fit.
+    std::uint16_t modifiers; // core::kModifier* flags sampled when the message arrived.
+    std::uint32_t wParam;    // Low 32 bits of wParam.
+};
+static_assert(sizeof(Event) == 12, "Recording events must stay compact");
+
+// Appends events through a large stdio buffer, so recording costs a memcpy per
+// message and a write syscall only every few thousand messages.
+class Recorder {
+public:
+    Recorder() = default;
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+    ~Recorder() { close(); }
+
+    bool open(const std::string& utf8Path, const FileHeader& header);
+    void close();
+    [[nodiscard]] bool is_open() const { return m_file != nullptr; }
+
+    void record(std::uint32_t message, std::uint64_t wParam, std::uint16_t modifiers,
+                std::chrono::steady_clock::time_point now);
+
+private:
+    std::FILE* m_file = nullptr;
+    std::chrono::steady_clock::time_point m_last;
+};
+
+class Reader {
+public:
+    Reader() = default;
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    ~Reader() { close(); }
+
+    // Opens a recording and validates its header.
+    bool open(const std::string& utf8Path, FileHeader& header);
+    void close();
+    // Reads the next event; returns false at the end of the recording.
+    bool next(Event& event);
+
+private:
+    std::FILE* m_file = nullptr;
+};
+
+} // namespace recording
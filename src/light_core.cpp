@@ -0,0 +1,109 @@
+#include "light_core.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+#include "log.h"
+
+namespace core {
+
+void LightCore::handle_key(unsigned key, unsigned modifiers) {
+    const bool fine = (modifiers & kModifierShift) != 0;
+    switch (key) {
+        case kKeyEscape:
+            m_state.quitRequested = true;
+            m_backend.request_quit();
+            break;
+        case kKeyUp:
+            change_gray_level(true, fine);
+            break;
+        case kKeyDown:
+            change_gray_level(false, fine);
+            break;
+        case kKeyLeft:
+            if (m_state.edgeLight) change_edge_band_width(false, fine ? 1 : config::kEdgeBandStep);
+            break;
+        case kKeyRight:
+            if (m_state.edgeLight) change_edge_band_width(true, fine ? 1 : config::kEdgeBandStep);
+            break;
+        case kKeyWarmer:
+            set_kelvin(m_state.kelvin - (fine ? config::kKelvinResolution : config::kKelvinStep));
+            break;
+        case kKeyCooler:
+            set_kelvin(m_state.kelvin + (fine ? config::kKelvinResolution : config::kKelvinStep));
+            break;
+        case kKeyM: // Toggle mouse movement
+            m_state.motionEnabled = !m_state.motionEnabled;
+            m_backend.set_motion_enabled(m_state.motionEnabled);
+            logMessage(m_state.motionEnabled ? "Mouse movement enabled." : "Mouse movement disabled.");
+            break;
+    }
+}
+
+void LightCore::handle_hotkey(unsigned id) {
+    if (id < std::size(kHotKeys)) {
+        handle_key(kHotKeys[id].key, kHotKeys[id].modifiers);
+    }
+}
+
+// Steps the gray level by 10, or by 1 when fine (a sixteenth of a level in dithered
+// mode). The level is tracked here rather than read back from the window's brush.
+void LightCore::change_gray_level(bool goLighter, bool fine) {
+    const int step = fine ? (m_state.dither ? 1 : dither::kSteps) : 10 * dither::kSteps;
+    set_fine_level(m_state.grayLevel * dither::kSteps + m_state.grayFraction + (goLighter ? step : -step));
+}
+
+// Sets the gray level, clamped to [0, 255].
+void LightCore::set_gray_level(int level) {
+    set_fine_level(std::clamp(level, 0, 255) * dither::kSteps);
+}
+
+// Sets the level in sixteenths of a gray step, clamped to [0, 255].
+void LightCore::set_fine_level(int sixteenths) {
+    const int clamped = std::clamp(sixteenths, 0, 255 * dither::kSteps);
+    const int newGrayLevel = clamped / dither::kSteps;
+    const int newFraction = clamped % dither::kSteps;
+    if (newGrayLevel != m_state.grayLevel || newFraction != m_state.grayFraction) {
+        m_state.grayLevel = newGrayLevel;
+        m_state.grayFraction = newFraction;
+        present();
+        logMessage("Screen brightness set to " + std::to_string(newGrayLevel) + "/255"
+            + (newFraction != 0 ? " + " + std::to_string(newFraction) + "/16 (dithered)" : ""));
+    }
+}
+
+// Sets the colour temperature, clamped to the blackbody table.
+void LightCore::set_kelvin(int kelvin) {
+    const int newKelvin = color::clamp_kelvin(kelvin);
+    if (newKelvin != m_state.kelvin) {
+        m_state.kelvin = newKelvin;
+        present();
+        logMessage("Colour temperature set to " + std::to_string(newKelvin) + "K");
+    }
+}
+
+// Hands the backend the light's colours: table lookups, no colour read back from the surface.
+void LightCore::present() {
+    const color::Rgb rgb = color::light_color(m_state.grayLevel, m_state.kelvin);
+    const color::Rgb next = m_state.grayFraction != 0 ? color::light_color(m_state.grayLevel + 1, m_state.kelvin) : rgb;
+    m_backend.set_light({m_state.grayLevel, m_state.grayFraction, m_state.kelvin, rgb, next});
+}
+
+// Widens or narrows the edge-light band.
+void LightCore::change_edge_band_width(bool goWider, int step) {
+    set_edge_band_width(m_state.edgeBandWidth + (goWider ? step : -step));
+}
+
+// Sets the edge-light band width, keeping it inside half the smaller surface dimension.
+void LightCore::set_edge_band_width(int width) {
+    const int maxWidth = std::max(std::min(m_state.surfaceWidth, m_state.surfaceHeight) / 2, config::kEdgeBandMin);
+    const int newWidth = std::clamp(width, config::kEdgeBandMin, maxWidth);
+    if (newWidth != m_state.edgeBandWidth) {
+        m_state.edgeBandWidth = newWidth;
+        m_backend.set_edge_band_width(newWidth);
+        logMessage("Edge band width set to " + std::to_string(newWidth) + "px");
+    }
+}
+
+} // namespace core
@@ -0,0 +1,118 @@
+#pragma once
+
+// Platform-independent behaviour of the light: how keys change brightness, motion
+// and the edge band, and when the application quits. The window procedure and the
+// replay harness both drive it; a Backend applies the resulting effects, either to
+// the real window or to a headless surface.
+
+#include <cstdint>
+
+#include "color_temperature.h"
+#include "config.h"
+#include "dither.h"
+
+namespace core {
+
+// Virtual-key codes the core responds to; identical to the Win32 VK_* values.
+constexpr unsigned kKeyEscape = 0x1B;
+constexpr unsigned kKeyLeft = 0x25;
+constexpr unsigned kKeyUp = 0x26;
+constexpr unsigned kKeyRight = 0x27;
+constexpr unsigned kKeyDown = 0x28;
+constexpr unsigned kKeyM = 'M';
+constexpr unsigned kKeyWarmer = 'W';
+constexpr unsigned kKeyCooler = 'C';
+
+// Modifier flags that accompany a key.
+constexpr unsigned kModifierShift = 0x1;
+
+// Window messages the replay harness models; identical to the Win32 WM_* values.
+constexpr std::uint32_t kMessagePaint = 0x000F;
+constexpr std::uint32_t kMessageKeyDown = 0x0100;
+constexpr std::uint32_t kMessageHotKey = 0x0312;
+
+// System-wide hotkeys, which work while another application has focus. Each stands for
+// a local key and goes through handle_key like it, so both feed the same brightness
+// path. A hotkey's id is its index here; the platform layer chooses the actual chord.
+struct HotKey {
+    unsigned key;       // The local key it acts as.
+    unsigned modifiers; // kModifier* flags passed along with it.
+    bool repeats;       // Whether holding the chord repeats it.
+};
+
+constexpr HotKey kHotKeys[] = {
+    {kKeyUp, 0, true},
+    {kKeyDown, 0, true},
+    {kKeyUp, kModifierShift, true},
+    {kKeyDown, kModifierShift, true},
+    {kKeyLeft, 0, true},
+    {kKeyRight, 0, true},
+    {kKeyM, 0, false},
+    {kKeyWarmer, 0, true},
+    {kKeyCooler, 0, true},
+};
+
+// A light to present. fraction is non-zero only in dithered mode: that many sixteenths of
+// the surface then show next, the colour one gray level up.
+struct Light {
+    int grayLevel;
+    int fraction;
+    int kelvin;
+    color::Rgb rgb;
+    color::Rgb next;
+};
+
+// Applies the core's decisions. Calls happen only on user actions, never per frame.
+class Backend {
+public:
+    virtual ~Backend() = default;
+    // Presents a new light. The surface is repainted on the next paint.
+    virtual void set_light(const Light& light) = 0;
+    virtual void set_edge_band_width(int width) = 0;
+    virtual void set_motion_enabled(bool enabled) = 0;
+    virtual void request_quit() = 0;
+};
+
+struct State {
+    int grayLevel = config::kInitialGrayLevel;
+    int grayFraction = 0; // Sixteenths of a level above grayLevel, in dithered mode.
+    int kelvin = config::kNeutralKelvin;
+    bool dither = false; // Shift steps by a sixteenth of a level, dithering between levels.
+    bool motionEnabled = true;
+    bool edgeLight = false;
+    int edgeBandWidth = config::kEdgeBandWidth;
+    int surfaceWidth = 0;
+    int surfaceHeight = 0;
+    bool quitRequested = false;
+};
+
+class LightCore {
+public:
+    explicit LightCore(Backend& backend) : m_backend(backend) {}
+
+    // Sets the starting state without notifying the backend.
+    void configure(const State& state) { m_state = state; }
+
+    void handle_key(unsigned key, unsigned modifiers);
+    // Applies the hotkey with the given id (an index into kHotKeys); unknown ids are ignored.
+    void handle_hotkey(unsigned id);
+
+    // Sets the gray level or band width directly (e.g. from a reloaded settings file),
+    // with the same clamping and notifications as the keys.
+    void set_gray_level(int level);
+    void set_kelvin(int kelvin);
+    void set_edge_band_width(int width);
+
+    [[nodiscard]] const State& state() const { return m_state; }
+
+private:
+    void change_gray_level(bool goLighter, bool fine);
+    void set_fine_level(int sixteenths);
+    void present();
+    void change_edge_band_width(bool goWider, int step);
+
+    Backend& m_backend;
+    State m_state;
+};
+
+} // namespace core
@@ -0,0 +1,11 @@
+#include "log.h"
+
+#include "output.h"
+
+bool g_isVerbose = false;
+
+void logMessage(const std::string& message) {
+    if (g_isVerbose) {
+        output::write_line(message);
+    }
+}
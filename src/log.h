@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+
+extern bool g_isVerbose; // Global flag to control logging output.
+
+// A simple logger that only prints messages if in verbose mode.
+void logMessage(const std::string& message);
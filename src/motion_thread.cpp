@@ -0,0 +1,178 @@
+#include "motion_thread.h"
+
+#include <algorithm>
+#include <climits>
+#include <string>
+
+#include "log.h"
+#include "telemetry.h"
+
+// Available since Windows 10 1803; older SDK headers may not define it.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+bool MotionThread::start(unsigned int periodMs, int velocity, CursorPoint origin) {
+    if (m_thread.joinable()) {
+        return true;
+    }
+    m_schedule.store(Schedule{periodMs, velocity}, std::memory_order_relaxed);
+    m_origin = origin;
+    m_wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    // Prefer a high-resolution timer; fall back to a standard one on older systems.
+    m_timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_MODIFY_STATE | SYNCHRONIZE);
+    m_highResolution = m_timer != NULL;
+    if (!m_timer) {
+        m_timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_MODIFY_STATE | SYNCHRONIZE);
+    }
+    if (!m_wakeEvent || !m_timer) {
+        if (m_wakeEvent) CloseHandle(m_wakeEvent);
+        if (m_timer) CloseHandle(m_timer);
+        m_wakeEvent = m_timer = NULL;
+        return false;
+    }
+    logMessage(m_highResolution ? "Motion thread using a high-resolution timer."
+                                : "Motion thread using a standard-resolution timer.");
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_thread = std::thread(&MotionThread::run, this);
+    return true;
+}
+
+void MotionThread::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    SetEvent(m_wakeEvent);
+    m_thread.join();
+    CloseHandle(m_timer);
+    CloseHandle(m_wakeEvent);
+    m_timer = m_wakeEvent = NULL;
+}
+
+void MotionThread::set_enabled(bool enabled) {
+    m_enabled.store(enabled, std::memory_order_relaxed);
+    if (m_wakeEvent) SetEvent(m_wakeEvent);
+}
+
+void MotionThread::set_paused(bool paused) {
+    if (m_paused.exchange(paused, std::memory_order_relaxed) != paused && m_wakeEvent) {
+        SetEvent(m_wakeEvent);
+    }
+}
+
+void MotionThread::set_period_ms(unsigned int periodMs) {
+    set_schedule(periodMs, m_schedule.load(std::memory_order_relaxed).velocity);
+}
+
+void MotionThread::set_schedule(unsigned int periodMs, int velocity) {
+    const Schedule previous = m_schedule.exchange(Schedule{periodMs, velocity}, std::memory_order_relaxed);
+    if ((previous.periodMs != periodMs || previous.velocity != velocity) && m_wakeEvent) {
+        SetEvent(m_wakeEvent);
+    }
+}
+
+void MotionThread::record_tick(std::chrono::microseconds jitter, bool moved) {
+    ++m_ticks;
+    m_moves += moved ? 1 : 0;
+    m_totalJitter += jitter;
+    if (jitter > m_maxJitter) m_maxJitter = jitter;
+
+    // All motion counters share one seqlock section, so a tick is a single update.
+    const std::uint32_t s = telemetry::begin_update(telemetry::Counter::TimerTicks);
+    telemetry::detail::slot(telemetry::Counter::TimerTicks).store(m_ticks, std::memory_order_relaxed);
+    telemetry::detail::slot(telemetry::Counter::CursorMoves).store(m_moves, std::memory_order_relaxed);
+    telemetry::detail::slot(telemetry::Counter::MotionJitterMaxUs).store(static_cast<std::uint64_t>(m_maxJitter.count()), std::memory_order_relaxed);
+    telemetry::detail::slot(telemetry::Counter::MotionJitterMeanUs).store(static_cast<std::uint64_t>(mean_jitter().count()), std::memory_order_relaxed);
+    telemetry::end_update(telemetry::Counter::TimerTicks, s);
+}
+
+void MotionThread::set_policies(MotionKind motion, BoundsKind bounds, ScreenRect subRect) {
+    m_motionKind = motion;
+    m_boundsKind = bounds;
+    m_subRect = subRect;
+}
+
+// The desktop area for the chosen bounds policy, in virtual-screen coordinates.
+ScreenRect MotionThread::bounds_area() const {
+    switch (m_boundsKind) {
+    case BoundsKind::VirtualDesktop: {
+        const int left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+        const int top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+        return {left, top, left + GetSystemMetrics(SM_CXVIRTUALSCREEN), top + GetSystemMetrics(SM_CYVIRTUALSCREEN)};
+    }
+    case BoundsKind::SubRect:
+        return m_subRect;
+    case BoundsKind::PrimaryScreen:
+        break;
+    }
+    return {0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)};
+}
+
+void MotionThread::run() {
+    // Pick the policies once; everything per tick is then specialized for them.
+    const ScreenRect area = bounds_area();
+    const CursorPoint start{area.left + m_origin.x, area.top + m_origin.y};
+    const int velocity = m_schedule.load(std::memory_order_relaxed).velocity;
+    with_motion_policy(m_motionKind, [&](auto motion) {
+        with_bounds_policy(m_boundsKind, [&](auto bounds) {
+            using Bounds = typename decltype(bounds)::type;
+            BasicMouseMover<typename decltype(motion)::type, Bounds> mover(Bounds(area), start, velocity);
+            run_loop(mover);
+        });
+    });
+}
+
+template <typename Mover>
+void MotionThread::run_loop(Mover& mover) {
+    using Clock = std::chrono::steady_clock;
+    const HANDLE handles[] = {m_wakeEvent, m_timer};
+    [[maybe_unused]] CursorPoint placed{INT_MIN, INT_MIN};
+
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        if (!is_active()) {
+            // Nothing to do until a parameter changes; no timer is armed meanwhile.
+            WaitForSingleObject(m_wakeEvent, INFINITE);
+            continue;
+        }
+
+        // Tick on an absolute schedule so wake-up latency does not accumulate as drift.
+        const Schedule schedule = m_schedule.load(std::memory_order_relaxed);
+        const auto period = std::chrono::milliseconds(schedule.periodMs);
+        mover.set_velocity(schedule.velocity);
+        auto deadline = Clock::now() + period;
+        while (is_active() && !m_stopRequested.load(std::memory_order_relaxed)) {
+            // Negative due times are relative, in 100 ns units.
+            const auto remaining = std::chrono::duration_cast<std::chrono::duration<LONGLONG, std::ratio<1, 10'000'000>>>(deadline - Clock::now());
+            LARGE_INTEGER due;
+            due.QuadPart = -(std::max)(remaining.count(), LONGLONG{1});
+            SetWaitableTimer(m_timer, &due, 0, NULL, NULL, FALSE);
+
+            if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0) {
+                CancelWaitableTimer(m_timer);
+                break; // A parameter changed; restart the schedule with the new values.
+            }
+
+            const auto now = Clock::now();
+            const CursorPoint point = mover.update();
+            bool moved = true;
+            if constexpr (Mover::kMovesEveryTick) {
+                SetCursorPos(point.x, point.y);
+            } else if (point != placed) {
+                // Policies that mostly hold still only touch the cursor when it moves.
+                SetCursorPos(point.x, point.y);
+                placed = point;
+            } else {
+                moved = false;
+            }
+            record_tick(std::chrono::duration_cast<std::chrono::microseconds>(now - deadline), moved);
+
+            // Policies that mostly hold still sleep through the ticks that would not move
+            // the cursor, rather than waking to leave it in place.
+            deadline += period * (1 + mover.skip_idle_ticks());
+            if (deadline <= now) {
+                deadline = now + period; // Skip ticks missed while the system was busy.
+            }
+        }
+    }
+}
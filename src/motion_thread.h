@@ -0,0 +1,97 @@
+#pragma once
+
+// Runs cursor motion on a dedicated worker thread paced by a high-resolution
+// waitable timer, so painting, modal loops or console output on the UI thread
+// never delay a tick, and motion is not limited to WM_TIMER's 10-16 ms granularity.
+// The global timer resolution is left alone (no timeBeginPeriod).
+//
+// The UI thread only flips the atomics below and signals a wake event; the worker
+// re-reads them when woken. While motion is disabled or paused the worker blocks
+// without any timer armed, and policies that mostly hold still arm it only for the
+// ticks that move the cursor.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "mouse_mover.h"
+
+class MotionThread {
+public:
+    MotionThread() = default;
+    MotionThread(const MotionThread&) = delete;
+    MotionThread& operator=(const MotionThread&) = delete;
+    ~MotionThread() { stop(); }
+
+    // Starts the worker ticking every periodMs, moving the cursor by velocity pixels per
+    // tick from origin, which is relative to the top-left of the bounds area so the same
+    // start works on any monitor. Returns false if it could not be started.
+    bool start(unsigned int periodMs, int velocity, CursorPoint origin);
+    void stop();
+    [[nodiscard]] bool is_running() const { return m_thread.joinable(); }
+
+    // Chooses how the cursor moves and the area it stays in. Call before start(); the
+    // worker instantiates its tick loop for exactly this combination.
+    void set_policies(MotionKind motion, BoundsKind bounds, ScreenRect subRect = {});
+
+    void set_enabled(bool enabled);
+    [[nodiscard]] bool is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // Suspends ticking entirely, e.g. while the display is off.
+    void set_paused(bool paused);
+    void set_period_ms(unsigned int periodMs);
+    // Changes the tick period and speed in one step, so no tick runs with only one of them.
+    void set_schedule(unsigned int periodMs, int velocity);
+
+    // Timer jitter (lateness of each wake-up against its deadline). Only safe to read
+    // once stop() has returned; live values are published through telemetry.
+    [[nodiscard]] std::uint64_t tick_count() const { return m_ticks; }
+    // SetCursorPos calls. Ticks are timer wakeups, so policies that hold still between
+    // moves wake only to move.
+    [[nodiscard]] std::uint64_t move_count() const { return m_moves; }
+    [[nodiscard]] std::chrono::microseconds max_jitter() const { return m_maxJitter; }
+    [[nodiscard]] std::chrono::microseconds mean_jitter() const {
+        return std::chrono::microseconds(m_ticks ? m_totalJitter.count() / static_cast<std::int64_t>(m_ticks) : 0);
+    }
+    [[nodiscard]] bool is_high_resolution() const { return m_highResolution; }
+
+private:
+    void run();
+    template <typename Mover>
+    void run_loop(Mover& mover);
+    [[nodiscard]] ScreenRect bounds_area() const;
+    [[nodiscard]] bool is_active() const {
+        return m_enabled.load(std::memory_order_relaxed) && !m_paused.load(std::memory_order_relaxed);
+    }
+    void record_tick(std::chrono::microseconds jitter, bool moved);
+
+    std::atomic<bool> m_enabled{true};
+    std::atomic<bool> m_paused{false};
+    std::atomic<bool> m_stopRequested{false};
+    // Tick period and cursor speed, published together. Only the UI thread writes it.
+    struct Schedule {
+        unsigned int periodMs = 0;
+        int velocity = 0;
+    };
+    static_assert(std::atomic<Schedule>::is_always_lock_free);
+    std::atomic<Schedule> m_schedule{};
+    CursorPoint m_origin{0, 0};
+    MotionKind m_motionKind = MotionKind::Bounce;
+    BoundsKind m_boundsKind = BoundsKind::PrimaryScreen;
+    ScreenRect m_subRect{0, 0, 0, 0};
+
+    HANDLE m_wakeEvent = NULL; // Auto-reset; signalled whenever a shared parameter changes.
+    HANDLE m_timer = NULL;
+    bool m_highResolution = false;
+    std::thread m_thread;
+
+    // Owned by the worker thread while it runs.
+    std::uint64_t m_ticks = 0;
+    std::uint64_t m_moves = 0;
+    std::chrono::microseconds m_maxJitter{0};
+    std::chrono::microseconds m_totalJitter{0};
+};
@@ -0,0 +1,332 @@
+#pragma once
+
+// Computes where the cursor goes on each motion tick. The mover is a template over a
+// motion policy (how the cursor travels) and a bounds policy (the area it stays in),
+// so each mode compiles to its own fully inlined update with no virtual calls and no
+// branches for the modes it is not. The runtime choice is made once, when the motion
+// thread starts (see with_motion_policy and with_bounds_policy below).
+//
+// Motion policies are constructed from (start, velocity, bounds) and provide
+// next(bounds), which returns the position for this tick and advances, and
+// set_velocity(velocity, bounds). kMovesEveryTick is false for policies that leave the
+// cursor in place on most ticks; those also provide skip_idle_ticks(), so callers can
+// sleep through the ticks that would not move it.
+// Bounds policies provide the inclusive pixel range min_x()..max_x(), min_y()..max_y().
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+
+#include "config.h"
+#include "log.h"
+
+// A cursor position, independent of the Windows POINT type so the core builds anywhere.
+struct CursorPoint {
+    int x;
+    int y;
+
+    bool operator==(const CursorPoint&) const = default;
+};
+
+// A screen area; right and bottom are exclusive, as in a Win32 RECT.
+struct ScreenRect {
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+enum class MotionKind {
+    Bounce,    // Diagonal bounce across the whole area.
+    Jiggle,    // Small back-and-forth step around the starting point.
+    Orbit,     // Circle around the centre of the area.
+    IdleNudge, // A one-tick nudge and return, once every kNudgeInterval ticks.
+};
+
+enum class BoundsKind {
+    PrimaryScreen,  // The primary monitor, whose origin is always (0, 0).
+    VirtualDesktop, // The bounding box of all monitors; its origin may be negative.
+    SubRect,        // A caller-chosen part of the desktop.
+};
+
+// The primary screen. Its origin is the compile-time constant (0, 0).
+class PrimaryScreenBounds {
+public:
+    PrimaryScreenBounds(int width, int height) : m_maxX(std::max(width - 1, 0)), m_maxY(std::max(height - 1, 0)) {}
+    explicit PrimaryScreenBounds(const ScreenRect& rect) : PrimaryScreenBounds(rect.right, rect.bottom) {}
+
+    static constexpr int min_x() { return 0; }
+    static constexpr int min_y() { return 0; }
+    int max_x() const { return m_maxX; }
+    int max_y() const { return m_maxY; }
+
+private:
+    int m_maxX, m_maxY;
+};
+
+// An arbitrary rectangle of the desktop.
+class RectBounds {
+public:
+    explicit RectBounds(const ScreenRect& rect)
+        : m_minX(rect.left), m_minY(rect.top),
+          m_maxX(std::max(rect.right - 1, rect.left)), m_maxY(std::max(rect.bottom - 1, rect.top)) {}
+
+    int min_x() const { return m_minX; }
+    int min_y() const { return m_minY; }
+    int max_x() const { return m_maxX; }
+    int max_y() const { return m_maxY; }
+
+private:
+    int m_minX, m_minY, m_maxX, m_maxY;
+};
+
+// The virtual desktop spanning all monitors.
+class VirtualDesktopBounds : public RectBounds {
+public:
+    using RectBounds::RectBounds;
+};
+
+// A part of the desktop chosen by the user.
+class SubRectBounds : public RectBounds {
+public:
+    using RectBounds::RectBounds;
+};
+
+namespace motion_detail {
+    template <typename Bounds>
+    CursorPoint clamp_to(CursorPoint point, const Bounds& bounds) {
+        return {std::clamp(point.x, bounds.min_x(), bounds.max_x()), std::clamp(point.y, bounds.min_y(), bounds.max_y())};
+    }
+
+    // A point velocity pixels diagonally away from anchor, towards the inside of the bounds.
+    template <typename Bounds>
+    CursorPoint offset_inside(CursorPoint anchor, int velocity, const Bounds& bounds) {
+        const int stepX = anchor.x + velocity <= bounds.max_x() ? velocity : -velocity;
+        const int stepY = anchor.y + velocity <= bounds.max_y() ? velocity : -velocity;
+        return clamp_to(CursorPoint{anchor.x + stepX, anchor.y + stepY}, bounds);
+    }
+}
+
+// Bounces diagonally, reversing direction at the edges of the bounds.
+class BounceMotion {
+public:
+    static constexpr bool kMovesEveryTick = true;
+
+    template <typename Bounds>
+    BounceMotion(CursorPoint start, int velocity, const Bounds& bounds)
+        : x(motion_detail::clamp_to(start, bounds).x), y(motion_detail::clamp_to(start, bounds).y), dx(velocity), dy(velocity) {}
+
+    template <typename Bounds>
+    CursorPoint next(const Bounds& bounds) {
+        const CursorPoint current{x, y};
+
+        // Bounce off the edges before a step would cross them, so the cursor never
+        // leaves the bounds.
+        if (x + dx < bounds.min_x() || x + dx > bounds.max_x()) {
+            dx = -dx; // Reverse horizontal direction
+        }
+        if (y + dy < bounds.min_y() || y + dy > bounds.max_y()) {
+            dy = -dy; // Reverse vertical direction
+        }
+
+        // Update the coordinates for the next position. An area narrower than a step
+        // leaves no room either way, so the cursor stays on its edge.
+        x = std::clamp(x + dx, bounds.min_x(), bounds.max_x());
+        y = std::clamp(y + dy, bounds.min_y(), bounds.max_y());
+        return current;
+    }
+
+    // Changes the speed without changing the direction of travel.
+    template <typename Bounds>
+    void set_velocity(int velocity, const Bounds&) {
+        dx = dx < 0 ? -velocity : velocity;
+        dy = dy < 0 ? -velocity : velocity;
+    }
+
+private:
+    int x, y, dx, dy;
+};
+
+// Alternates between the starting point and a point velocity pixels away from it,
+// stepping towards the inside of the bounds.
+class JiggleMotion {
+public:
+    static constexpr bool kMovesEveryTick = true;
+
+    template <typename Bounds>
+    JiggleMotion(CursorPoint start, int velocity, const Bounds& bounds)
+        : m_anchor(motion_detail::clamp_to(start, bounds)),
+          m_offset(motion_detail::offset_inside(m_anchor, velocity, bounds)) {}
+
+    template <typename Bounds>
+    CursorPoint next(const Bounds&) {
+        const CursorPoint current = m_atOffset ? m_offset : m_anchor;
+        m_atOffset = !m_atOffset;
+        return current;
+    }
+
+    template <typename Bounds>
+    void set_velocity(int velocity, const Bounds& bounds) {
+        m_offset = motion_detail::offset_inside(m_anchor, velocity, bounds);
+    }
+
+private:
+    CursorPoint m_anchor;
+    CursorPoint m_offset;
+    bool m_atOffset = false;
+};
+
+// Circles the centre of the bounds at velocity pixels per tick along the circle. The
+// position is advanced by a fixed rotation rather than per-tick trigonometry, and its
+// radius is restored periodically so rounding does not make the circle drift.
+class OrbitMotion {
+public:
+    static constexpr bool kMovesEveryTick = true;
+
+    template <typename Bounds>
+    OrbitMotion(CursorPoint, int velocity, const Bounds& bounds)
+        : m_centerX((bounds.min_x() + bounds.max_x()) / 2.0),
+          m_centerY((bounds.min_y() + bounds.max_y()) / 2.0),
+          m_radius(std::max(std::min(bounds.max_x() - bounds.min_x(), bounds.max_y() - bounds.min_y()) / 4.0, 1.0)),
+          m_x(m_radius) {
+        set_velocity(velocity, bounds);
+    }
+
+    template <typename Bounds>
+    CursorPoint next(const Bounds&) {
+        const CursorPoint current{static_cast<int>(std::lround(m_centerX + m_x)), static_cast<int>(std::lround(m_centerY + m_y))};
+        const double x = m_x * m_cos - m_y * m_sin;
+        m_y = m_x * m_sin + m_y * m_cos;
+        m_x = x;
+        if (++m_ticks % kRenormalizeInterval == 0) {
+            const double scale = m_radius / std::hypot(m_x, m_y);
+            m_x *= scale;
+            m_y *= scale;
+        }
+        return current;
+    }
+
+    template <typename Bounds>
+    void set_velocity(int velocity, const Bounds&) {
+        const double step = velocity / m_radius;
+        m_cos = std::cos(step);
+        m_sin = std::sin(step);
+    }
+
+private:
+    static constexpr unsigned kRenormalizeInterval = 1024;
+
+    double m_centerX, m_centerY, m_radius;
+    double m_x, m_y = 0.0;
+    double m_cos = 1.0, m_sin = 0.0;
+    unsigned m_ticks = 0;
+};
+
+// Leaves the cursor at the starting point, moving it velocity pixels away for a
+// single tick every kNudgeInterval ticks: just enough input to register activity.
+class IdleNudgeMotion {
+public:
+    static constexpr bool kMovesEveryTick = false;
+    static constexpr unsigned kNudgeInterval = 64;
+
+    template <typename Bounds>
+    IdleNudgeMotion(CursorPoint start, int velocity, const Bounds& bounds)
+        : m_anchor(motion_detail::clamp_to(start, bounds)),
+          m_offset(motion_detail::offset_inside(m_anchor, velocity, bounds)) {}
+
+    template <typename Bounds>
+    CursorPoint next(const Bounds&) {
+        const bool nudge = m_ticks++ % kNudgeInterval == kNudgeInterval - 1;
+        return nudge ? m_offset : m_anchor;
+    }
+
+    // Advances past the coming ticks that stay at the anchor, up to the next nudge, and
+    // returns how many. Right after a nudge the next tick is the return, so none are.
+    unsigned skip_idle_ticks() {
+        const unsigned phase = m_ticks % kNudgeInterval;
+        const unsigned idle = phase == 0 ? 0 : kNudgeInterval - 1 - phase;
+        m_ticks += idle;
+        return idle;
+    }
+
+    template <typename Bounds>
+    void set_velocity(int velocity, const Bounds& bounds) {
+        m_offset = motion_detail::offset_inside(m_anchor, velocity, bounds);
+    }
+
+private:
+    CursorPoint m_anchor;
+    CursorPoint m_offset;
+    unsigned m_ticks = 0;
+};
+
+// Moves the cursor according to a motion policy inside a bounds policy. It only
+// computes positions; the caller places the cursor. Not thread-safe: it is owned by
+// whoever drives the ticks (the motion thread in the application, the replayer in tests).
+template <typename Motion, typename Bounds>
+class BasicMouseMover {
+public:
+    using MotionPolicy = Motion;
+    using BoundsPolicy = Bounds;
+    static constexpr bool kMovesEveryTick = Motion::kMovesEveryTick;
+
+    explicit BasicMouseMover(const Bounds& bounds, CursorPoint start = {config::kInitialX, config::kInitialY},
+                             int velocity = config::kVelocity)
+        : m_bounds(bounds), m_motion(start, velocity, m_bounds) {
+        logMessage("MouseMover initialized. Area: (" + std::to_string(m_bounds.min_x()) + ", " + std::to_string(m_bounds.min_y())
+            + ") to (" + std::to_string(m_bounds.max_x()) + ", " + std::to_string(m_bounds.max_y()) + ")");
+    }
+
+    // Returns where to move the cursor now and advances to the next position.
+    CursorPoint update() { return m_motion.next(m_bounds); }
+
+    void set_velocity(int velocity) { m_motion.set_velocity(velocity, m_bounds); }
+
+    // Advances past the coming ticks that would leave the cursor where the last update()
+    // put it, and returns how many, so the caller can sleep through them.
+    unsigned skip_idle_ticks() {
+        if constexpr (kMovesEveryTick) {
+            return 0;
+        } else {
+            return m_motion.skip_idle_ticks();
+        }
+    }
+
+private:
+    Bounds m_bounds;
+    Motion m_motion;
+};
+
+// The original behaviour: a diagonal bounce around the primary screen.
+using MouseMover = BasicMouseMover<BounceMotion, PrimaryScreenBounds>;
+
+// Calls fn with std::type_identity<Policy>{} for the policy selected at runtime, so the
+// caller instantiates its whole tick loop once per policy instead of branching per tick.
+template <typename Fn>
+decltype(auto) with_motion_policy(MotionKind kind, Fn&& fn) {
+    switch (kind) {
+    case MotionKind::Jiggle:
+        return fn(std::type_identity<JiggleMotion>{});
+    case MotionKind::Orbit:
+        return fn(std::type_identity<OrbitMotion>{});
+    case MotionKind::IdleNudge:
+        return fn(std::type_identity<IdleNudgeMotion>{});
+    case MotionKind::Bounce:
+        break;
+    }
+    return fn(std::type_identity<BounceMotion>{});
+}
+
+template <typename Fn>
+decltype(auto) with_bounds_policy(BoundsKind kind, Fn&& fn) {
+    switch (kind) {
+    case BoundsKind::VirtualDesktop:
+        return fn(std::type_identity<VirtualDesktopBounds>{});
+    case BoundsKind::SubRect:
+        return fn(std::type_identity<SubRectBounds>{});
+    case BoundsKind::PrimaryScreen:
+        break;
+    }
+    return fn(std::type_identity<PrimaryScreenBounds>{});
+}
@@ -0,0 +1,134 @@
+#include "output.h"
+
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <unistd.h> // For write
+#endif
+
+namespace output {
+
+namespace {
+    // Lines up to this length are formatted on the stack.
+    constexpr std::size_t kStackLine = 512;
+
+    // Room for a line plus its newline, on the stack unless the line is unusually long.
+    template <typename Char>
+    class LineBuffer {
+    public:
+        explicit LineBuffer(std::size_t length) {
+            if (length + 1 > kStackLine) {
+                m_heap.resize(length + 1);
+                m_data = m_heap.data();
+            }
+        }
+        Char* data() { return m_data; }
+
+    private:
+        Char m_stack[kStackLine];
+        std::basic_string<Char> m_heap;
+        Char* m_data = m_stack;
+    };
+
+    // Copies a line into the buffer and terminates it with a newline.
+    char* copy_line(LineBuffer<char>& buffer, std::string_view utf8) {
+        char* line = buffer.data();
+        std::memcpy(line, utf8.data(), utf8.size());
+        line[utf8.size()] = '\n';
+        return line;
+    }
+
+#ifdef _WIN32
+    HANDLE s_console = INVALID_HANDLE_VALUE;
+    bool s_isConsole = false; // False when the output is redirected to a file or pipe.
+#endif
+}
+
+#ifdef _WIN32
+
+bool open_console() {
+    if (s_console != INVALID_HANDLE_VALUE) {
+        return true;
+    }
+    // Try to attach to the parent process's console. If that fails (e.g., launched
+    // from the GUI), allocate a new console for logging. This makes --verbose robust.
+    if (!AttachConsole(ATTACH_PARENT_PROCESS)) {
+        AllocConsole();
+    }
+    // Prefer an inherited redirection (e.g. `ScreenLight --verbose > log.txt`), else the console itself.
+    HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (handle == NULL || handle == INVALID_HANDLE_VALUE) {
+        handle = CreateFileW(L"CONOUT$", GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                             NULL, OPEN_EXISTING, 0, NULL);
+    }
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    s_console = handle;
+    s_isConsole = GetConsoleMode(handle, &mode) != FALSE;
+    return true;
+}
+
+void close_console() {
+    if (s_console == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    s_console = INVALID_HANDLE_VALUE;
+    FreeConsole();
+}
+
+void write_line(std::string_view utf8) {
+    if (s_console == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    DWORD written = 0;
+    if (!s_isConsole) {
+        // Redirected: pass the UTF-8 bytes through unchanged.
+        LineBuffer<char> buffer(utf8.size());
+        const char* line = copy_line(buffer, utf8);
+        WriteFile(s_console, line, static_cast<DWORD>(utf8.size() + 1), &written, NULL);
+        return;
+    }
+
+    // The console wants UTF-16: one conversion pass into a buffer sized for the worst case.
+    // UTF-8 never needs fewer bytes than UTF-16 needs code units, so utf8.size() is enough.
+    LineBuffer<wchar_t> buffer(utf8.size());
+    wchar_t* line = buffer.data();
+    const int length = utf8.empty() ? 0 : MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), line, static_cast<int>(utf8.size()));
+    line[length] = L'\n';
+    WriteConsoleW(s_console, line, static_cast<DWORD>(length + 1), &written, NULL);
+}
+
+#else
+
+bool open_console() {
+    return true;
+}
+
+void close_console() {
+}
+
+void write_line(std::string_view utf8) {
+    LineBuffer<char> buffer(utf8.size());
+    const char* cursor = copy_line(buffer, utf8);
+    std::size_t remaining = utf8.size() + 1;
+    while (remaining > 0) {
+        const ssize_t written = write(STDOUT_FILENO, cursor, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        cursor += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+}
+
+#endif
+
+} // namespace output
@@ -0,0 +1,24 @@
+#pragma once
+
+// Minimal line output for verbose logging, written straight through the OS instead of
+// <iostream>, so a statically linked build does not carry locale and stream setup
+// that non-verbose runs never use. Nothing is initialized until open_console().
+//
+// On Windows, lines go to the console with WriteConsoleW (converted from UTF-8) or,
+// when the console output is redirected, to the file or pipe as UTF-8 via WriteFile.
+// Elsewhere they are written to standard output with write(2).
+
+#include <string_view>
+
+namespace output {
+
+// Prepares the output channel. On Windows this attaches to the parent's console or
+// allocates a new one. Returns false if no channel is available.
+bool open_console();
+void close_console();
+
+// Writes one line followed by a newline. Safe to call from any thread; each line is a
+// single write, so lines from different threads do not interleave.
+void write_line(std::string_view utf8);
+
+} // namespace output
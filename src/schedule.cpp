@@ -0,0 +1,254 @@
+#include "schedule.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+
+#include "file_io.h"
+
+namespace schedule {
+
+namespace {
+    // Room for tens of thousands of keyframes.
+    constexpr std::size_t kMaxFileSize = 4 * 1024 * 1024;
+
+    // Plain loops rather than find_first_of: a file can hold tens of thousands of lines.
+    bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && is_space(text.front())) text.remove_prefix(1);
+        while (!text.empty() && is_space(text.back())) text.remove_suffix(1);
+        return text;
+    }
+
+    // Splits off the next space-separated field.
+    std::string_view next_field(std::string_view& text) {
+        std::size_t begin = 0;
+        while (begin < text.size() && is_space(text[begin])) ++begin;
+        std::size_t end = begin;
+        while (end < text.size() && !is_space(text[end])) ++end;
+        const std::string_view field = text.substr(begin, end - begin);
+        text.remove_prefix(end);
+        return field;
+    }
+
+    // Every field is a small non-negative number, so digits are accumulated directly.
+    bool parse_int(std::string_view text, int& value) {
+        if (text.empty() || text.size() > 6) {
+            return false;
+        }
+        int parsed = 0;
+        for (const char c : text) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            parsed = parsed * 10 + (c - '0');
+        }
+        value = parsed;
+        return true;
+    }
+
+    // "HH:MM" or "HH:MM:SS", 00:00 to 23:59:59.
+    bool parse_time(std::string_view text, int& dayMs) {
+        int hours = 0;
+        int minutes = 0;
+        int seconds = 0;
+        const std::size_t colon = text.find(':');
+        const std::size_t second = colon == std::string_view::npos ? colon : text.find(':', colon + 1);
+        if (colon == std::string_view::npos || !parse_int(text.substr(0, colon), hours)
+            || !parse_int(text.substr(colon + 1, second == std::string_view::npos ? second : second - colon - 1), minutes)
+            || (second != std::string_view::npos && !parse_int(text.substr(second + 1), seconds))) {
+            return false;
+        }
+        if (hours < 0 || hours > 23 || minutes < 0 || minutes > 59 || seconds < 0 || seconds > 59) {
+            return false;
+        }
+        dayMs = ((hours * 60 + minutes) * 60 + seconds) * 1000;
+        return true;
+    }
+
+    // A value in quantization units: gray levels, or Kelvin in kKelvinResolution steps.
+    struct Channel {
+        double from;
+        double to;
+    };
+
+    double value_at(const Channel& channel, long long start, long long end, long long t) {
+        return channel.from + (channel.to - channel.from) * static_cast<double>(t - start) / static_cast<double>(end - start);
+    }
+
+    // The first time in [from, limit) at which the channel rounds to something other
+    // than quantized, or limit if it does not. Solved directly, then nudged by a
+    // millisecond or two to absorb floating-point rounding.
+    long long first_exit(const Channel& channel, long long start, long long end, long long from, long long limit,
+                         long quantized) {
+        if (channel.to == channel.from) {
+            return limit;
+        }
+        const bool rising = channel.to > channel.from;
+        const double boundary = quantized + (rising ? 0.5 : -0.5);
+        const double solved = start + (boundary - channel.from) / (channel.to - channel.from) * static_cast<double>(end - start);
+        if (solved >= static_cast<double>(limit)) {
+            return limit;
+        }
+        long long t = std::max(from, static_cast<long long>(std::ceil(solved)));
+        const auto moved = [&](long long at) { return std::lround(value_at(channel, start, end, at)) != quantized; };
+        while (t > from && moved(t - 1)) --t;
+        while (t < limit && !moved(t)) ++t;
+        return t;
+    }
+}
+
+bool Schedule::assign(std::vector<Keyframe> keyframes, std::string& error) {
+    for (const Keyframe& keyframe : keyframes) {
+        if (keyframe.dayMs < 0 || keyframe.dayMs >= kDayMs || keyframe.grayLevel < 0 || keyframe.grayLevel > 255
+            || keyframe.kelvin < config::kMinKelvin || keyframe.kelvin > config::kMaxKelvin) {
+            error = "keyframe out of range";
+            return false;
+        }
+    }
+    const auto earlier = [](const Keyframe& a, const Keyframe& b) { return a.dayMs < b.dayMs; };
+    // Files are normally written in order, so the sort is usually skipped.
+    if (!std::is_sorted(keyframes.begin(), keyframes.end(), earlier)) {
+        std::sort(keyframes.begin(), keyframes.end(), earlier);
+    }
+    const auto duplicate = std::adjacent_find(keyframes.begin(), keyframes.end(),
+                                              [](const Keyframe& a, const Keyframe& b) { return a.dayMs == b.dayMs; });
+    if (duplicate != keyframes.end()) {
+        char time[16];
+        const int seconds = duplicate->dayMs / 1000;
+        std::snprintf(time, sizeof(time), "%02d:%02d:%02d", seconds / 3600, seconds / 60 % 60, seconds % 60);
+        error = "two keyframes at " + std::string(time);
+        return false;
+    }
+    m_keyframes = std::move(keyframes);
+    return true;
+}
+
+Schedule::Segment Schedule::segment_at(int dayMs) const {
+    const auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), dayMs,
+                                       [](int t, const Keyframe& keyframe) { return t < keyframe.dayMs; });
+    const Keyframe& from = next == m_keyframes.begin() ? m_keyframes.back() : *(next - 1);
+    const Keyframe& to = next == m_keyframes.end() ? m_keyframes.front() : *next;
+    const long long start = next == m_keyframes.begin() ? from.dayMs - kDayMs : from.dayMs;
+    const long long end = next == m_keyframes.end() ? to.dayMs + kDayMs : to.dayMs;
+    return {&from, &to, start, end};
+}
+
+Output Schedule::at(int dayMs) const {
+    const Segment s = segment_at(dayMs);
+    const Channel gray{static_cast<double>(s.from->grayLevel), static_cast<double>(s.to->grayLevel)};
+    const Channel kelvin{static_cast<double>(s.from->kelvin) / config::kKelvinResolution,
+                         static_cast<double>(s.to->kelvin) / config::kKelvinResolution};
+    return {static_cast<int>(std::lround(value_at(gray, s.start, s.end, dayMs))),
+            static_cast<int>(std::lround(value_at(kelvin, s.start, s.end, dayMs))) * config::kKelvinResolution};
+}
+
+std::optional<int> Schedule::until_change(int dayMs) const {
+    if (m_keyframes.size() < 2) {
+        return std::nullopt;
+    }
+    const Output current = at(dayMs);
+    const long gray = current.grayLevel;
+    const long kelvin = current.kelvin / config::kKelvinResolution;
+    // Walk the segments of the next 24 hours; the values are continuous across
+    // keyframes, so each segment is solved on its own.
+    const long long horizon = static_cast<long long>(dayMs) + kDayMs;
+    long long t = dayMs;
+    while (t < horizon) {
+        const long long dayStart = t - t % kDayMs;
+        const Segment s = segment_at(static_cast<int>(t % kDayMs));
+        const long long start = s.start + dayStart;
+        const long long end = std::min(s.end + dayStart, horizon);
+        const Channel grayChannel{static_cast<double>(s.from->grayLevel), static_cast<double>(s.to->grayLevel)};
+        const Channel kelvinChannel{static_cast<double>(s.from->kelvin) / config::kKelvinResolution,
+                                    static_cast<double>(s.to->kelvin) / config::kKelvinResolution};
+        const long long fullEnd = s.end + dayStart;
+        const long long change = std::min(first_exit(grayChannel, start, fullEnd, t, end, gray),
+                                          first_exit(kelvinChannel, start, fullEnd, t, end, kelvin));
+        if (change < end) {
+            return static_cast<int>(change - dayMs);
+        }
+        t = end;
+    }
+    return std::nullopt;
+}
+
+bool parse(std::string_view text, Schedule& schedule, std::string& error) {
+    std::vector<Keyframe> keyframes;
+    keyframes.reserve(static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+    int lineNumber = 0;
+    while (!text.empty()) {
+        const std::size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        ++lineNumber;
+
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        Keyframe keyframe{0, 0};
+        const std::string_view timeText = next_field(line);
+        const std::string_view grayText = next_field(line);
+        const std::string_view kelvinText = next_field(line);
+        if (!parse_time(timeText, keyframe.dayMs) || !parse_int(grayText, keyframe.grayLevel)
+            || (!kelvinText.empty() && !parse_int(kelvinText, keyframe.kelvin)) || !trim(line).empty()) {
+            error = "line " + std::to_string(lineNumber) + ": expected HH:MM[:SS] BRIGHTNESS [KELVIN]";
+            return false;
+        }
+        if (keyframe.grayLevel < 0 || keyframe.grayLevel > 255 || keyframe.kelvin < config::kMinKelvin
+            || keyframe.kelvin > config::kMaxKelvin) {
+            error = "line " + std::to_string(lineNumber) + ": brightness must be 0-255 and Kelvin "
+                + std::to_string(config::kMinKelvin) + "-" + std::to_string(config::kMaxKelvin);
+            return false;
+        }
+        keyframes.push_back(keyframe);
+    }
+    if (keyframes.empty()) {
+        error = "no keyframes";
+        return false;
+    }
+    return schedule.assign(std::move(keyframes), error);
+}
+
+bool load_file(const std::string& utf8Path, Schedule& schedule, std::string& error) {
+    std::FILE* file = file_io::open_file(utf8Path, false);
+    if (!file) {
+        error = "cannot open the file";
+        return false;
+    }
+    std::string text;
+    char buffer[16384];
+    std::size_t read = 0;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0 && text.size() <= kMaxFileSize) {
+        text.append(buffer, read);
+    }
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed || text.size() > kMaxFileSize) {
+        error = failed ? "could not read the file" : "the file is too large";
+        return false;
+    }
+    return parse(text, schedule, error);
+}
+
+int local_day_ms() {
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    std::tm local = {};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    const auto sinceSecond = now - std::chrono::system_clock::from_time_t(seconds);
+    const int ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(sinceSecond).count());
+    return ((local.tm_hour * 60 + local.tm_min) * 60 + std::min(local.tm_sec, 59)) * 1000 + std::clamp(ms, 0, 999);
+}
+
+} // namespace schedule
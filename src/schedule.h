@@ -0,0 +1,80 @@
+#pragma once
+
+// Brightness and colour temperature by time of day, e.g. dimmer and warmer in the
+// evening. A schedule is a table of keyframes sorted by time of day; between two
+// keyframes both values are interpolated linearly, and the last keyframe of the day
+// leads into the first one of the next day.
+//
+// Evaluation is lazy. The output is quantized the way the light shows it (whole gray
+// levels, kKelvinResolution steps), so until_change() can solve for the next moment
+// the quantized output differs and the application sleeps until exactly then.
+//
+// Schedule files hold one keyframe per line, "HH:MM[:SS] BRIGHTNESS [KELVIN]", with '#'
+// starting a comment. Like the settings file, a file is applied all or nothing.
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.h"
+
+namespace schedule {
+
+constexpr int kDayMs = 24 * 60 * 60 * 1000;
+
+struct Keyframe {
+    int dayMs;     // Milliseconds since local midnight.
+    int grayLevel; // 0-255
+    int kelvin = config::kNeutralKelvin;
+};
+
+struct Output {
+    int grayLevel;
+    int kelvin;
+
+    bool operator==(const Output&) const = default;
+};
+
+class Schedule {
+public:
+    // Replaces the keyframes, sorting them if they are not in order already. Fails with
+    // a reason, leaving the schedule as it was, if a value is out of range or two
+    // keyframes share a time.
+    bool assign(std::vector<Keyframe> keyframes, std::string& error);
+
+    [[nodiscard]] bool empty() const { return m_keyframes.empty(); }
+    [[nodiscard]] std::size_t size() const { return m_keyframes.size(); }
+
+    // The quantized output at a time of day. Must not be called on an empty schedule.
+    [[nodiscard]] Output at(int dayMs) const;
+
+    // Milliseconds from dayMs to the first moment at() returns something else, within
+    // the next 24 hours; nullopt if the output never changes.
+    [[nodiscard]] std::optional<int> until_change(int dayMs) const;
+
+private:
+    // The keyframes a time of day falls between, with their times unwrapped around it
+    // (start <= dayMs < end, where start may be negative and end past kDayMs).
+    struct Segment {
+        const Keyframe* from;
+        const Keyframe* to;
+        long long start;
+        long long end;
+    };
+    [[nodiscard]] Segment segment_at(int dayMs) const;
+
+    std::vector<Keyframe> m_keyframes;
+};
+
+// Parses the text of a schedule file into a schedule. On failure, returns false with a
+// description of the first bad line in error and leaves the schedule untouched.
+bool parse(std::string_view text, Schedule& schedule, std::string& error);
+
+// Reads and parses the file at a UTF-8 path.
+bool load_file(const std::string& utf8Path, Schedule& schedule, std::string& error);
+
+// Milliseconds since local midnight now.
+int local_day_ms();
+
+} // namespace schedule
@@ -1,159 +1,867 @@
 // C++ Standard Library
 #include <new>       // Required for placement new, used by std::string/vector in C++20+
 #include <chrono>    // For std/::chrono for type-safe time durations
-#include <cstdio>    // For freopen_s to redirect streams
+#include <cstdio>    // For snprintf when formatting stall records
 #include <cstdlib>
-#include <iostream>
-#include <string>    // For std::string to parse command-line arguments
-#include <vector>    // For std::vector to hold arguments
+#include <algorithm> // For std::max
+#include <iterator>  // For std::size over the hotkey table
+#include <ctime>     // For formatting stall timestamps
+#include <string>    // For std::string log messages and UTF-8 paths
+#include <string_view> // For the parsed command-line arguments
+#include <memory>    // For the ambient light source
+#include <optional>  // For the time to the next schedule change
+#include <vector>    // For the readings of one ambient poll
 
 // Windows API - Include last, with macros to reduce header size and avoid conflicts.
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h> // For core Windows API functions
-#include <shellapi.h> // For CommandLineToArgvW
+#include <wtsapi32.h> // For session lock and unlock notifications
 #include "resource.h" // For our application icon ID
+#include "config.h"    // For the tunable constants
+#include "command_line.h" // For the typed command-line options
+#include "file_io.h"   // For converting the wide arguments and paths to UTF-8
+#include "log.h"       // For logMessage
+#include "output.h"    // For the verbose console channel
+#include "motion_thread.h" // For cursor motion on its own high-resolution timer
+#include "hud.h"           // For the brightness overlay
+#include "light_core.h"    // For the platform-independent key handling
+#include "dither.h"        // For the dithered brush between two gray levels
+#include "input_recording.h" // For --record message stream capture
+#include "telemetry.h" // For the shared-memory health counters
+#include "footprint.h" // For working-set sampling and the post-startup trim
+#include "settings.h"  // For the hot-reloaded settings file
+#include "session_state.h" // For the last-used brightness, motion and monitor
+#include "watchdog.h"  // For the message-loop stall watchdog
+#include "timeline.h"  // For the coroutine tasks sharing one window timer
+#include "flight_recorder.h" // For the crash-surviving event ring
+#include "ambient.h"   // For brightness following a room light sensor
+#include "schedule.h"  // For time-of-day brightness and colour temperature
+#include "cpu_governor.h" // For keeping the tick rate inside the CPU budget
+#include "gamma_ramp.h"   // For --gamma-ramp brightness without repaints
 
 // Custom message used to signal a graceful shutdown from the console handler.
 #define WM_APP_SHUTDOWN (WM_APP + 1)
-// Timer ID for the mouse movement timer.
-#define IDT_MOUSEMOVE_TIMER 1
+// Custom message carrying reloaded settings (a const settings::Values* in lParam) to the window.
+#define WM_APP_SETTINGS (WM_APP + 2)
+// Custom message sent by the main loop when the ambient light source has text waiting.
+#define WM_APP_AMBIENT (WM_APP + 3)
+// The timeline's single timer; only armed while a timeline task is waiting.
+#define IDT_TIMELINE 1
 
-bool g_isVerbose = false; // Global flag to control logging output.
+cli::Options g_options;     // Parsed once at startup; path options point into the command line.
+DWORD g_mainThreadId = 0;   // Receives WM_QUIT from the console handler when there is no window.
+bool g_isEdgeLight = false; // Global flag selecting the border-band overlay mode.
+bool g_exitAfterStartup = false; // Quit once the first frame is shown, for startup measurements.
 HWND g_hMainWnd = NULL;   // Global handle to the main window for cross-thread communication.
+StallWatchdog g_watchdog; // Reports message-loop dispatches that run longer than the threshold.
+recording::Recorder g_recorder; // Captures the message stream when --record=PATH is given.
+std::string g_recordPath;      // Set from --record=PATH.
+bool g_trimAfterStartup = false; // Set from --trim-after-startup.
+MotionKind g_motionKind = MotionKind::Bounce;       // Set from --motion=NAME.
+BoundsKind g_boundsKind = BoundsKind::PrimaryScreen; // Set from --bounds=NAME or --bounds=L,T,R,B.
+ScreenRect g_boundsRect{0, 0, 0, 0};                 // The sub-rectangle for --bounds=L,T,R,B.
 
-// A simple logger that only prints messages if in verbose mode.
-void logMessage(const std::string& message) {
-    if (g_isVerbose) {
-        std::cout << message << std::endl;
+// Running settings: the compiled defaults, then the settings file, then command-line
+// overrides. Only the UI thread reads or replaces them.
+settings::Values g_settings;
+std::string g_configPath;          // Set from --config=PATH, else ScreenLight.conf beside the executable.
+settings::FileWatcher g_configWatcher; // Signals the message loop when the settings file changes.
+
+// What this run starts with and last showed: restored from the state file, overridden by
+// the command line. Persisted in the background whenever the user changes it.
+session::State g_session;
+std::string g_statePath;         // Set from --state=PATH, else ScreenLight.state beside the executable.
+std::string g_flightPath;        // Set from --flight-recorder=PATH, else ScreenLight.flight beside the executable.
+session::Writer g_sessionWriter; // Debounces and writes g_session off the UI thread.
+
+// With --gamma-ramp the surface stays white and the light is shown through the display's
+// gamma ramp, so a level change is a table upload instead of a repaint.
+gamma_ramp::Driver g_gammaRamp;
+std::string g_gammaPath; // The saved original ramp: beside the state file.
+
+// Arms the timeline's one window timer. SetTimer with the same ID replaces the previous
+// arming, so re-arming never accumulates timers.
+class Win32Timer final : public timeline::Timer {
+public:
+    void attach(HWND hwnd) { m_hwnd = hwnd; }
+    void arm(std::chrono::milliseconds delay) override { SetTimer(m_hwnd, IDT_TIMELINE, static_cast<UINT>(delay.count()), NULL); }
+    void disarm() override { KillTimer(m_hwnd, IDT_TIMELINE); }
+
+private:
+    HWND m_hwnd = NULL;
+};
+
+// Delayed and periodic UI-thread work (HUD fades, footprint sampling), multiplexed onto IDT_TIMELINE.
+Win32Timer g_timelineTimer;
+timeline::Scheduler g_timeline(g_timelineTimer, std::chrono::milliseconds(config::kFrameDelayMs));
+timeline::TaskId g_footprintTask = 0;
+
+// Power settings we subscribe to. Defined locally rather than through <initguid.h>,
+// which would instantiate every GUID declared by the Windows headers in this file.
+constexpr GUID kGuidConsoleDisplayState = {0x6fe69556, 0x704a, 0x47a0, {0x8f, 0x24, 0xc2, 0x8d, 0x93, 0x6f, 0xda, 0x47}};
+constexpr GUID kGuidAcDcPowerSource = {0x5d3e9a59, 0xe9d5, 0x4b00, {0xa6, 0xbd, 0xff, 0x34, 0xff, 0x51, 0x65, 0x48}};
+
+// Tracks the power, display and session states reported by the system, and decides
+// how the motion timer and painting should run. Every transition arrives as a window
+// message, so nothing is ever polled.
+class PowerScheduler {
+public:
+    // Subscribes to display, power-source and session notifications for the window.
+    // The system immediately sends the current value of each power setting.
+    void register_notifications(HWND hwnd) {
+        m_displayNotify = RegisterPowerSettingNotification(hwnd, &kGuidConsoleDisplayState, DEVICE_NOTIFY_WINDOW_HANDLE);
+        m_sourceNotify = RegisterPowerSettingNotification(hwnd, &kGuidAcDcPowerSource, DEVICE_NOTIFY_WINDOW_HANDLE);
+        m_sessionNotify = WTSRegisterSessionNotification(hwnd, NOTIFY_FOR_THIS_SESSION);
+        if (!m_displayNotify || !m_sourceNotify || !m_sessionNotify) {
+            logMessage("Warning: Could not subscribe to all power and session notifications.");
+        }
+    }
+
+    void unregister_notifications(HWND hwnd) {
+        if (m_displayNotify) UnregisterPowerSettingNotification(m_displayNotify);
+        if (m_sourceNotify) UnregisterPowerSettingNotification(m_sourceNotify);
+        if (m_sessionNotify) WTSUnRegisterSessionNotification(hwnd);
+        m_displayNotify = m_sourceNotify = NULL;
+        m_sessionNotify = FALSE;
+    }
+
+    // Applies a WM_POWERBROADCAST message. Returns true if the schedule changed.
+    bool on_power_broadcast(WPARAM event, LPARAM lParam) {
+        switch (event) {
+        case PBT_APMSUSPEND:
+            return update(m_suspended, true, "System suspending.");
+        case PBT_APMRESUMEAUTOMATIC:
+        case PBT_APMRESUMESUSPEND:
+            return update(m_suspended, false, "System resumed.");
+        case PBT_POWERSETTINGCHANGE: {
+            const auto* setting = reinterpret_cast<const POWERBROADCAST_SETTING*>(lParam);
+            if (!setting || setting->DataLength < sizeof(DWORD)) {
+                return false;
+            }
+            const DWORD value = *reinterpret_cast<const DWORD*>(setting->Data);
+            if (IsEqualGUID(setting->PowerSetting, kGuidConsoleDisplayState)) {
+                // 0 = off, 1 = on, 2 = dimmed. A dimmed display is still visible, so keep lighting it.
+                return update(m_displayOff, value == 0, value == 0 ? "Display turned off." : "Display is on.");
+            }
+            if (IsEqualGUID(setting->PowerSetting, kGuidAcDcPowerSource)) {
+                // 0 = AC, 1 = battery (DC), 2 = short-term source such as a UPS.
+                return update(m_onBattery, value != 0, value != 0 ? "Running on battery power." : "Running on AC power.");
+            }
+            return false;
+        }
+        }
+        return false;
+    }
+
+    // Applies a WM_WTSSESSION_CHANGE message. Returns true if the schedule changed.
+    bool on_session_change(WPARAM event) {
+        switch (event) {
+        case WTS_SESSION_LOCK:
+            return update(m_locked, true, "Session locked.");
+        case WTS_SESSION_UNLOCK:
+            return update(m_locked, false, "Session unlocked.");
+        }
+        return false;
+    }
+
+    // True when nobody can see the light, so neither motion nor painting is useful.
+    [[nodiscard]] bool is_paused() const {
+        return m_displayOff || m_locked || m_suspended;
+    }
+
+    // The frame delay the settings ask for on the current power source.
+    [[nodiscard]] UINT base_frame_delay_ms() const {
+        return m_onBattery ? g_settings.batteryFrameDelayMs : g_settings.frameDelayMs;
+    }
+
+    // The frame delay to run at: the base delay, or longer while the CPU governor throttles.
+    [[nodiscard]] UINT frame_delay_ms() const {
+        return std::max(base_frame_delay_ms(), m_governedDelayMs);
+    }
+
+    void set_governed_delay_ms(UINT delayMs) { m_governedDelayMs = delayMs; }
+
+    // Hands the current tick rate and pause state to the motion thread. Both are
+    // atomics there, so this never blocks on the worker.
+    void apply_motion_schedule(MotionThread& motion) const {
+        motion.set_period_ms(frame_delay_ms());
+        motion.set_paused(is_paused());
     }
+
+    // Records that a paint was skipped while paused, so resuming repaints exactly once.
+    void mark_paint_skipped() { m_paintSkipped = true; }
+
+    [[nodiscard]] bool take_paint_skipped() {
+        const bool skipped = m_paintSkipped;
+        m_paintSkipped = false;
+        return skipped;
+    }
+
+private:
+    bool update(bool& state, bool value, const char* message) {
+        if (state == value) {
+            return false;
+        }
+        state = value;
+        logMessage(message);
+        return true;
+    }
+
+    HPOWERNOTIFY m_displayNotify = NULL;
+    HPOWERNOTIFY m_sourceNotify = NULL;
+    BOOL m_sessionNotify = FALSE;
+    bool m_displayOff = false;
+    bool m_locked = false;
+    bool m_suspended = false;
+    bool m_onBattery = false;
+    bool m_paintSkipped = false;
+    UINT m_governedDelayMs = 0;
+};
+
+// Keeps motion and animation inside the CPU budget (cpu_budget_permille). Samples run
+// on the timeline every kGovernorIntervalMs while the light is visible; nothing is
+// sampled while it is paused.
+governor::Governor g_governor;
+timeline::TaskId g_governorTask = 0;
+
+// Applies the governor's frame delay to the motion thread and the HUD fade.
+void ApplyGovernedDelay(UINT delayMs, PowerScheduler& power, MotionThread& motion, Hud& hud) {
+    power.set_governed_delay_ms(delayMs);
+    power.apply_motion_schedule(motion);
+    hud.set_min_frame_delay(std::chrono::milliseconds(delayMs));
+    telemetry::set(telemetry::Counter::GovernedFrameDelayMs, power.frame_delay_ms());
 }
 
-// Use a dedicated namespace for configuration constants to keep them organized and reusable.
-namespace config {
-    constexpr int kInitialX = 100;
-    constexpr int kInitialY = 100;
-    constexpr int kVelocity = 2;
-    // Using UINT for timer duration to match SetTimer's expectations. ~60 FPS
-    constexpr UINT kFrameDelayMs = 16;
+// Samples the process's CPU time and the system load, and publishes them with the
+// governed delay and the motion tick rate actually achieved.
+timeline::Task GovernCpu(PowerScheduler& power, MotionThread& motion, Hud& hud) {
+    governor::CpuSample last = governor::take_sample();
+    g_governor.update(last, power.base_frame_delay_ms());
+    std::uint64_t lastTicks = telemetry::value(telemetry::Counter::TimerTicks);
+    while (true) {
+        co_await g_timeline.after(std::chrono::milliseconds(config::kGovernorIntervalMs));
+        const governor::CpuSample sample = governor::take_sample();
+        const std::uint64_t throttlesBefore = g_governor.throttle_count();
+        if (g_governor.update(sample, power.base_frame_delay_ms())) {
+            ApplyGovernedDelay(g_governor.frame_delay_ms(), power, motion, hud);
+            if (g_governor.throttle_count() != throttlesBefore) {
+                flight::record(flight::Event::Throttle, static_cast<std::uint16_t>(g_governor.frame_delay_ms()),
+                               static_cast<std::uint64_t>(g_governor.usage_permille()));
+                logMessage("CPU governor: " + std::to_string(g_governor.usage_permille()) + "/1000 of a core (system "
+                    + std::to_string(g_governor.system_busy_percent()) + "% busy); frame delay raised to "
+                    + std::to_string(g_governor.frame_delay_ms()) + "ms.");
+            } else {
+                logMessage("CPU governor: headroom; frame delay lowered to " + std::to_string(g_governor.frame_delay_ms()) + "ms.");
+            }
+        }
+        const std::uint64_t ticks = telemetry::value(telemetry::Counter::TimerTicks);
+        const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(sample.at - last.at).count();
+        telemetry::set(telemetry::Counter::CpuUsagePermille, static_cast<std::uint64_t>(std::max(g_governor.usage_permille(), 0)));
+        telemetry::set(telemetry::Counter::SystemBusyPercent, static_cast<std::uint64_t>(std::max(g_governor.system_busy_percent(), 0)));
+        telemetry::set(telemetry::Counter::ThrottleEvents, g_governor.throttle_count());
+        if (elapsedUs > 0) {
+            telemetry::set(telemetry::Counter::MotionTickRateMilliHz,
+                           (ticks - lastTicks) * 1'000'000'000 / static_cast<std::uint64_t>(elapsedUs));
+        }
+        last = sample;
+        lastTicks = ticks;
+    }
 }
 
-class MouseMover {
-public:
-    MouseMover()
-        : screenWidth(GetSystemMetrics(SM_CXSCREEN)),
-          screenHeight(GetSystemMetrics(SM_CYSCREEN)),
-          x(config::kInitialX),
-          y(config::kInitialY),
-          dx(config::kVelocity),
-          dy(config::kVelocity) {
-        logMessage("MouseMover initialized. Screen: " + std::to_string(screenWidth) + "x" + std::to_string(screenHeight));
+// (Re)starts the governor for the current budget and power state. An unlimited budget
+// drops any throttling at once.
+void RestartGovernor(PowerScheduler& power, MotionThread& motion, Hud& hud) {
+    g_timeline.cancel(g_governorTask);
+    g_governorTask = 0;
+    g_governor.set_budget_permille(g_settings.cpuBudgetPermille);
+    telemetry::set(telemetry::Counter::CpuBudgetPermille, static_cast<std::uint64_t>(g_settings.cpuBudgetPermille));
+    if (g_settings.cpuBudgetPermille <= 0) {
+        ApplyGovernedDelay(0, power, motion, hud);
+    } else if (!power.is_paused()) {
+        g_governorTask = g_timeline.spawn(GovernCpu(power, motion, hud));
     }
+}
+
+void RestartAmbient(const PowerScheduler& power, core::LightCore& light);
+void RestartFootprint(const PowerScheduler& power);
+
+// Reschedules motion, the governor, the ambient source and footprint sampling after a
+// power, display or session transition, and repaints once if painting was skipped
+// while the light was hidden.
+void OnPowerScheduleChanged(HWND hwnd, PowerScheduler& power, MotionThread& motion, Hud& hud, core::LightCore& light) {
+    flight::record(flight::Event::Schedule, power.is_paused() ? 1 : 0, power.frame_delay_ms());
+    power.apply_motion_schedule(motion);
+    RestartGovernor(power, motion, hud);
+    RestartAmbient(power, light);
+    RestartFootprint(power);
+    if (!power.is_paused() && power.take_paint_skipped()) {
+        InvalidateRect(hwnd, NULL, TRUE);
+    }
+}
+
+// Samples and publishes the footprint. The first sample after startup is kept as the
+// steady-state footprint, since by then the first frame is long done (and trimmed, if asked).
+void PublishFootprint() {
+    static bool steadyRecorded = false;
+    const footprint::Sample sample = footprint::take_sample();
+    footprint::publish(sample);
+    flight::record(flight::Event::Footprint, 0, sample.workingSetBytes);
+    // Keeps the flight recorder's clock conversion fresh, should the next sample never come.
+    flight::calibrate();
+    if (!steadyRecorded) {
+        steadyRecorded = true;
+        footprint::publish_steady(sample);
+        logMessage("Steady-state footprint: " + footprint::describe(sample));
+    } else {
+        logMessage("Footprint: " + footprint::describe(sample));
+    }
+}
+
+// Samples the footprint every footprint interval, until cancelled.
+timeline::Task SampleFootprint() {
+    while (true) {
+        co_await g_timeline.after(std::chrono::milliseconds(g_settings.footprintIntervalMs));
+        PublishFootprint();
+    }
+}
 
-    void update() {
-        // Move the cursor to the new (x, y) position.
-        SetCursorPos(x, y);
+// Samples the footprint only while the light is visible. The first sample after a
+// pause comes one interval after resuming.
+void RestartFootprint(const PowerScheduler& power) {
+    g_timeline.cancel(g_footprintTask);
+    g_footprintTask = 0;
+    if (!power.is_paused()) {
+        g_footprintTask = g_timeline.spawn(SampleFootprint());
+    }
+}
 
-        // Update the coordinates for the next position.
-        x += dx;
-        y += dy;
+// Brightness following a room light sensor (--ambient=SPEC). The source is read when its
+// wait handle is signalled in the main wait, or polled on the timeline if it has none,
+// and only while the light is visible. Only a change of the controller's quantized
+// target starts a fade, so a burst of readings that does not move the target costs no repaint.
+std::unique_ptr<ambient::Source> g_ambientSource;
+ambient::SampleParser g_ambientParser;
+ambient::Controller g_ambientController;
+timeline::TaskId g_ambientFadeTask = 0;
+timeline::TaskId g_ambientPollTask = 0;
+bool g_ambientListening = false; // The main wait includes the source's wait handle.
 
-        // Bounce off the screen edges.
-        if (x <= 0 || x >= screenWidth - 1) {
-            dx = -dx; // Reverse horizontal direction
+// Steps the gray level to the target by at most one quantum per step, at a limited
+// rate. A level set by hand meanwhile wins: the fade stops until the next target change.
+timeline::Task FadeToAmbient(core::LightCore& light, int target) {
+    constexpr auto kStepDelay = std::chrono::milliseconds(1000 * config::kAmbientQuantum / config::kAmbientLevelsPerSecond);
+    int level = light.state().grayLevel;
+    while (true) {
+        level += std::clamp(target - level, -config::kAmbientQuantum, config::kAmbientQuantum);
+        light.set_gray_level(level);
+        if (level == target) {
+            co_return;
         }
-        if (y <= 0 || y >= screenHeight - 1) {
-            dy = -dy; // Reverse vertical direction
+        co_await g_timeline.after(kStepDelay);
+        if (light.state().grayLevel != level || light.state().grayFraction != 0) {
+            co_return;
         }
     }
+}
+
+// Reads whatever the source delivered and fades to the controller's target if it moved.
+void ReadAmbient(core::LightCore& light) {
+    std::string text;
+    std::vector<double> readings;
+    g_ambientSource->read(text);
+    g_ambientParser.feed(text, readings);
+    if (readings.empty()) {
+        return;
+    }
+    telemetry::add(telemetry::Counter::AmbientSamples, readings.size());
+    if (g_ambientController.update(readings, timeline::Clock::now())) {
+        const int target = g_ambientController.target();
+        telemetry::set(telemetry::Counter::AmbientTarget, static_cast<std::uint64_t>(target));
+        flight::record(flight::Event::AmbientTarget, static_cast<std::uint16_t>(target), readings.size());
+        g_timeline.cancel(g_ambientFadeTask);
+        g_ambientFadeTask = g_timeline.spawn(FadeToAmbient(light, target));
+    }
+}
 
-    void toggle() {
-        m_enabled = !m_enabled;
-        logMessage(m_enabled ? "Mouse movement enabled." : "Mouse movement disabled.");
+// Reads a source that cannot be waited on every poll interval, until cancelled.
+timeline::Task PollAmbient(core::LightCore& light) {
+    while (true) {
+        ReadAmbient(light);
+        co_await g_timeline.after(std::chrono::milliseconds(config::kAmbientPollMs));
     }
+}
 
-    [[nodiscard]] bool is_enabled() const {
-        return m_enabled;
+// Follows the source while the light is visible and stops reading it while paused.
+// Readings that arrive meanwhile wait in the source and are read on resume.
+void RestartAmbient(const PowerScheduler& power, core::LightCore& light) {
+    g_timeline.cancel(g_ambientPollTask);
+    g_ambientPollTask = 0;
+    g_ambientListening = false;
+    if (!g_ambientSource || power.is_paused()) {
+        return;
     }
+    if (g_ambientSource->wait_handle() != ambient::Source::kNoWaitHandle) {
+        g_ambientListening = true;
+    } else {
+        g_ambientPollTask = g_timeline.spawn(PollAmbient(light));
+    }
+}
 
-private:
-    int screenWidth, screenHeight, x, y, dx, dy;
-    bool m_enabled = true; // Movement is enabled by default.
-};
+// Brightness and colour temperature by time of day (--schedule=PATH). The task sleeps
+// until the next moment the schedule's quantized output changes; nothing polls. With
+// --ambient too, the sensor drives the brightness and the schedule only the colour.
+schedule::Schedule g_schedule;
+timeline::TaskId g_scheduleTask = 0;
+
+// Applies the schedule now and at each change. A level set by hand holds until the
+// schedule's next change.
+timeline::Task FollowSchedule(core::LightCore& light) {
+    while (true) {
+        const int dayMs = schedule::local_day_ms();
+        const schedule::Output output = g_schedule.at(dayMs);
+        if (!g_ambientSource) {
+            light.set_gray_level(output.grayLevel);
+        }
+        light.set_kelvin(output.kelvin);
+        const std::optional<int> untilChange = g_schedule.until_change(dayMs);
+        if (!untilChange) {
+            co_return;
+        }
+        co_await g_timeline.after(std::chrono::milliseconds(*untilChange));
+    }
+}
+
+// (Re)starts following the schedule from the current wall-clock time, e.g. after the
+// clock was changed or the system resumed, either of which moves local time against
+// the timeline's steady clock.
+void RestartSchedule(core::LightCore& light) {
+    if (g_schedule.empty()) {
+        return;
+    }
+    g_timeline.cancel(g_scheduleTask);
+    g_scheduleTask = g_timeline.spawn(FollowSchedule(light));
+}
+
+// Commits reloaded settings. This runs on the UI thread between two messages, so every
+// handler sees either the old values or the new ones, and the motion thread receives
+// its period and speed as one update. Startup-only values (initial position, stall
+// threshold) are kept and take effect on the next start.
+void ApplySettings(const settings::Values& next, PowerScheduler& power,
+                   MotionThread& motion, core::LightCore& light, Hud& hud) {
+    const settings::Values previous = g_settings;
+    g_settings = next;
+    motion.set_schedule(power.frame_delay_ms(), next.velocity);
+    if (next.grayLevel != previous.grayLevel) {
+        light.set_gray_level(next.grayLevel);
+    }
+    if (next.kelvin != previous.kelvin) {
+        light.set_kelvin(next.kelvin);
+    }
+    if (next.edgeBandWidth != previous.edgeBandWidth && g_isEdgeLight) {
+        light.set_edge_band_width(next.edgeBandWidth);
+    }
+    if (next.footprintIntervalMs != previous.footprintIntervalMs) {
+        // Restart the sampling loop so the new interval applies from now.
+        RestartFootprint(power);
+    }
+    if (next.cpuBudgetPermille != previous.cpuBudgetPermille) {
+        RestartGovernor(power, motion, hud);
+    }
+    flight::record(flight::Event::SettingsReloaded);
+    logMessage("Settings reloaded from " + g_configPath);
+}
 
 // Forward declaration of the window procedure.
 LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
 BOOL WINAPI ConsoleHandler(DWORD);
 
-// Updates the window's background color to a new shade of gray.
-void UpdateBackgroundColor(HWND hwnd, bool goLighter, int step) {
-    // Retrieve the current background brush from the window class to determine the current color.
-    HBRUSH hOldBrush = (HBRUSH)GetClassLongPtr(hwnd, GCLP_HBRBACKGROUND);
-    BYTE currentGrayLevel = 255; // Default to white if retrieval fails.
+// Publishes the process's current GDI object count. This is a syscall, so it is only
+// refreshed after operations that create or delete GDI objects.
+void PublishGdiHandleCount() {
+    telemetry::set(telemetry::Counter::GdiHandles, GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS));
+}
+
+// Registers the system-wide hotkeys as Ctrl+Alt plus the local key (and Shift for fine
+// steps). RegisterHotKey posts WM_HOTKEY to this thread's queue, so no keyboard hook
+// ever sits in front of other applications' keystrokes. A chord another application
+// already owns is skipped; the local key still works.
+void RegisterHotKeys(HWND hwnd) {
+    int failed = 0;
+    for (std::size_t id = 0; id < std::size(core::kHotKeys); ++id) {
+        const core::HotKey& hotKey = core::kHotKeys[id];
+        UINT modifiers = MOD_CONTROL | MOD_ALT;
+        if (hotKey.modifiers & core::kModifierShift) modifiers |= MOD_SHIFT;
+        if (!hotKey.repeats) modifiers |= MOD_NOREPEAT;
+        if (!RegisterHotKey(hwnd, static_cast<int>(id), modifiers, hotKey.key)) {
+            ++failed;
+        }
+    }
+    if (failed > 0) {
+        logMessage("Warning: " + std::to_string(failed) + " hotkey(s) are taken by another application.");
+    } else {
+        logMessage("Hotkeys registered: Ctrl+Alt+Up/Down (Shift for fine steps), Ctrl+Alt+Left/Right, Ctrl+Alt+M.");
+    }
+}
+
+void UnregisterHotKeys(HWND hwnd) {
+    for (std::size_t id = 0; id < std::size(core::kHotKeys); ++id) {
+        UnregisterHotKey(hwnd, static_cast<int>(id));
+    }
+}
 
-    if (hOldBrush) {
-        LOGBRUSH lb;
-        if (GetObject(hOldBrush, sizeof(LOGBRUSH), &lb)) {
-            // Assuming the color is a shade of gray, so R, G, and B components are equal.
-            currentGrayLevel = GetRValue(lb.lbColor);
+// Restricts the window to a border band of the given width around the screen.
+// The window region is both the paint clip and the hit-test area, so the centre
+// becomes click-through and brightness changes only repaint the band pixels.
+// This runs once per band width change; nothing here is evaluated per frame.
+void ApplyEdgeBandRegion(HWND hwnd, int bandWidth) {
+    RECT rc;
+    GetClientRect(hwnd, &rc);
+    HRGN hOuter = CreateRectRgn(rc.left, rc.top, rc.right, rc.bottom);
+    HRGN hInner = CreateRectRgn(rc.left + bandWidth, rc.top + bandWidth, rc.right - bandWidth, rc.bottom - bandWidth);
+    if (hOuter && hInner && CombineRgn(hOuter, hOuter, hInner, RGN_DIFF) != ERROR) {
+        // On success the system owns the region, so it must not be deleted here.
+        if (SetWindowRgn(hwnd, hOuter, TRUE)) {
+            hOuter = NULL;
         }
     }
+    if (hInner) DeleteObject(hInner);
+    if (hOuter) DeleteObject(hOuter);
+}
 
-    int newGrayLevel = currentGrayLevel;
+// Creates a pattern brush holding the dither tile between the light's two levels. The
+// tile is rendered into a small 32-bit DIB once per level change; painting with the
+// class brush then repeats it across the surface like a solid colour.
+HBRUSH CreateDitherBrush(const core::Light& light) {
+    struct PackedDib {
+        BITMAPINFOHEADER header;
+        std::uint32_t pixels[dither::kTileSize * dither::kTileSize];
+    } dib = {};
+    dib.header.biSize = sizeof(BITMAPINFOHEADER);
+    dib.header.biWidth = dither::kTileSize;
+    dib.header.biHeight = dither::kTileSize; // Bottom-up, so the top row is stored last.
+    dib.header.biPlanes = 1;
+    dib.header.biBitCount = 32;
+    dib.header.biCompression = BI_RGB;
+    const dither::Tile tile = dither::make_tile(dither::pack(light.rgb), dither::pack(light.next), light.fraction);
+    dither::fill(dib.pixels + (dither::kTileSize - 1) * dither::kTileSize, dither::kTileSize, dither::kTileSize,
+                 -dither::kTileSize, tile);
+    return CreateDIBPatternBrushPt(&dib, DIB_RGB_COLORS);
+}
 
-    if (goLighter) {
-        newGrayLevel += step;
-        if (newGrayLevel > 255) newGrayLevel = 255;
-    } else { // goDarker
-        newGrayLevel -= step;
-        if (newGrayLevel < 0) newGrayLevel = 0;
+// Starts cursor motion with the current policies and schedule. The thread is only
+// created once motion is first enabled, so --edge-light and --no-motion never create it
+// unless the user turns motion on.
+bool StartMotionThread(MotionThread& motion, const PowerScheduler& power) {
+    if (motion.is_running()) {
+        return true;
     }
+    motion.set_policies(g_motionKind, g_boundsKind, g_boundsRect);
+    // The initial point is relative to the bounds, so on --monitor or --bounds the cursor
+    // starts inside that area rather than at the same desktop point.
+    if (!motion.start(power.frame_delay_ms(), g_settings.velocity, CursorPoint{g_settings.initialX, g_settings.initialY})) {
+        logMessage("Warning: Could not start the motion thread.");
+        return false;
+    }
+    power.apply_motion_schedule(motion);
+    return true;
+}
 
-    if (newGrayLevel != currentGrayLevel) {
-        BYTE newGrayByte = static_cast<BYTE>(newGrayLevel);
+// Applies the core's decisions to the real window and the motion thread.
+class Win32Backend final : public core::Backend {
+public:
+    Win32Backend(MotionThread& motion, const PowerScheduler& power) : m_motion(motion), m_power(power) {}
+
+    // Binds the backend to the window once it exists (on WM_CREATE).
+    void attach(HWND hwnd) { m_hwnd = hwnd; }
+
+    // Swaps the window class brush for one of the new colour and repaints with it. The
+    // colour comes from the core, so the current one is never read back from GDI.
+    void set_light(const core::Light& light) override {
+        flight::record(flight::Event::Light, static_cast<std::uint16_t>(light.grayLevel),
+                       static_cast<std::uint64_t>(light.kelvin) << 8 | static_cast<std::uint64_t>(light.fraction));
+        if (g_gammaRamp.is_active()) {
+            const bool wasShowing = g_gammaRamp.is_showing();
+            const bool shown = g_gammaRamp.show(light);
+            telemetry::set(telemetry::Counter::GammaUploads, g_gammaRamp.upload_count());
+            // The ramp carries the light, so the white surface only needs painting when
+            // the previous light was refused and painted instead.
+            if (shown && (wasShowing || paint(CreateSolidBrush(RGB(255, 255, 255))))) {
+                publish(light);
+                return;
+            }
+        }
         // Create a new brush with the updated color
-        HBRUSH hNewBrush = CreateSolidBrush(RGB(newGrayByte, newGrayByte, newGrayByte));
-        if (hNewBrush) {
-            // Set the new brush as the background for the window class.
-            HBRUSH hReplacedBrush = (HBRUSH)SetClassLongPtr(hwnd, GCLP_HBRBACKGROUND, (LONG_PTR)hNewBrush);
-            if (hReplacedBrush) DeleteObject(hReplacedBrush);
-            // Force the window to repaint with the new background
-            InvalidateRect(hwnd, NULL, TRUE);
-            logMessage("Screen brightness set to " + std::to_string(newGrayByte) + "/255");
+        HBRUSH hNewBrush = light.fraction != 0 ? CreateDitherBrush(light) : CreateSolidBrush(RGB(light.rgb.r, light.rgb.g, light.rgb.b));
+        if (paint(hNewBrush)) {
+            publish(light);
         }
     }
-}
 
-// Parses the application's command line into a vector of strings.
-std::vector<std::string> ParseCommandLine() {
-    std::vector<std::string> args;
-    int argc = 0;
-    LPWSTR* argvW = CommandLineToArgvW(GetCommandLineW(), &argc);
-    if (argvW) {
-        // Start from 1 to skip the program name, matching standard argv behavior.
-        for (int i = 1; i < argc; ++i) {
-            int wlen = lstrlenW(argvW[i]);
-            int size_needed = WideCharToMultiByte(CP_UTF8, 0, argvW[i], wlen, NULL, 0, NULL, NULL);
-            std::string arg(size_needed, 0);
-            WideCharToMultiByte(CP_UTF8, 0, argvW[i], wlen, &arg[0], size_needed, NULL, NULL);
-            args.push_back(std::move(arg));
+    void set_edge_band_width(int width) override {
+        ApplyEdgeBandRegion(m_hwnd, width);
+    }
+
+    void set_motion_enabled(bool enabled) override {
+        flight::record(flight::Event::Motion, enabled ? 1 : 0);
+        if (enabled) {
+            StartMotionThread(m_motion, m_power);
         }
-        LocalFree(argvW);
+        m_motion.set_enabled(enabled);
+        ShowCursor(enabled); // Sync cursor visibility with the movement state.
+    }
+
+    void request_quit() override {
+        DestroyWindow(m_hwnd);
     }
-    return args;
-}
 
-// Sets the verbose flag based on command-line arguments.
-void setup_verbosity_from_args(const std::vector<std::string>& args) {
-    for (const auto& arg : args) {
-        if (arg == "--verbose") {
-            g_isVerbose = true;
-            return;
+private:
+    // Sets the brush as the background for the window class and repaints with it.
+    bool paint(HBRUSH hNewBrush) {
+        if (!hNewBrush) {
+            return false;
         }
+        HBRUSH hReplacedBrush = (HBRUSH)SetClassLongPtr(m_hwnd, GCLP_HBRBACKGROUND, (LONG_PTR)hNewBrush);
+        if (hReplacedBrush) DeleteObject(hReplacedBrush);
+        InvalidateRect(m_hwnd, NULL, TRUE);
+        PublishGdiHandleCount();
+        return true;
+    }
+
+    static void publish(const core::Light& light) {
+        telemetry::set(telemetry::Counter::Brightness, static_cast<std::uint64_t>(light.grayLevel));
+        telemetry::set(telemetry::Counter::ColorTemperatureK, static_cast<std::uint64_t>(light.kelvin));
+    }
+
+    HWND m_hwnd = NULL;
+    MotionThread& m_motion;
+    const PowerScheduler& m_power;
+};
+
+// Returns the named file in the executable's directory, as a UTF-8 path.
+std::string PathBesideExecutable(const char* fileName) {
+    wchar_t modulePath[MAX_PATH];
+    const DWORD length = GetModuleFileNameW(NULL, modulePath, MAX_PATH);
+    if (length == 0 || length == MAX_PATH) {
+        return fileName;
+    }
+    const std::wstring_view path(modulePath, length);
+    return file_io::narrow(path.substr(0, path.find_last_of(L"\\/") + 1)) + fileName;
+}
+
+// Copies the flags and startup choices from the command line into the application's globals.
+void setup_from_options(const cli::Options& options) {
+    g_isVerbose = options.verbose;
+    g_isEdgeLight = options.edgeLight;
+    g_exitAfterStartup = options.exitAfterStartup;
+    g_trimAfterStartup = options.trimAfterStartup;
+    g_recordPath = file_io::narrow(options.recordPath);
+    g_configPath = options.configPath.empty() ? PathBesideExecutable("ScreenLight.conf") : file_io::narrow(options.configPath);
+    g_statePath = options.statePath.empty() ? PathBesideExecutable("ScreenLight.state") : file_io::narrow(options.statePath);
+    g_flightPath = options.flightPath.empty() ? PathBesideExecutable("ScreenLight.flight") : file_io::narrow(options.flightPath);
+    g_gammaPath = options.statePath.empty() ? PathBesideExecutable("ScreenLight.gamma") : g_statePath + ".gamma";
+    if (options.motion) {
+        g_motionKind = *options.motion;
+    }
+    if (options.bounds) {
+        g_boundsKind = *options.bounds;
+        g_boundsRect = options.boundsRect;
+    }
+}
+
+// A crash skips the normal exit, so the original ramp goes back before the process dies.
+// A kill cannot be caught; the next run's recovery covers that.
+LONG WINAPI RestoreGammaRampOnCrash(EXCEPTION_POINTERS*) {
+    g_gammaRamp.restore();
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+// Puts back a gamma ramp left dimmed by a run that crashed or was killed, with or
+// without --gamma-ramp on this run.
+void RecoverGammaRamp() {
+    std::string error;
+    switch (gamma_ramp::recover(g_gammaPath, error)) {
+    case gamma_ramp::RecoverResult::Restored:
+        logMessage("Restored the display gamma ramp left by a run that did not exit cleanly.");
+        break;
+    case gamma_ramp::RecoverResult::Failed:
+        logMessage("Warning: Could not restore the gamma ramp saved in " + g_gammaPath + ": " + error);
+        break;
+    case gamma_ramp::RecoverResult::Nothing:
+        break;
+    }
+}
+
+// Takes over the gamma ramp of the monitor under the surface for --gamma-ramp and shows
+// the first light through it. Returns false if the surface has to be painted instead.
+bool StartGammaRamp(const RECT& surface, const core::Light& light) {
+    if (g_isEdgeLight) {
+        // The ramp would dim the user's work in the centre along with the band.
+        logMessage("Warning: Ignoring --gamma-ramp in edge-light mode.");
+        return false;
+    }
+    MONITORINFOEXW info = {};
+    info.cbSize = sizeof(info);
+    const HMONITOR monitor = MonitorFromRect(&surface, MONITOR_DEFAULTTOPRIMARY);
+    const std::string device =
+        GetMonitorInfoW(monitor, reinterpret_cast<MONITORINFO*>(&info)) ? file_io::narrow(info.szDevice) : std::string();
+    std::string error;
+    if (!g_gammaRamp.start(gamma_ramp::open_device(device, error), g_gammaPath, error)) {
+        logMessage("Warning: Ignoring --gamma-ramp: " + error);
+        return false;
+    }
+    SetUnhandledExceptionFilter(RestoreGammaRampOnCrash);
+    logMessage("Showing the light through the gamma ramp of " + device);
+    const bool shown = g_gammaRamp.show(light);
+    telemetry::set(telemetry::Counter::GammaUploads, g_gammaRamp.upload_count());
+    if (!shown) {
+        logMessage("The display refused the ramp for this light; painting it instead.");
+    }
+    return shown;
+}
+
+// Writes the current ramp again after the system reset it. Nothing without --gamma-ramp.
+void ReapplyGammaRamp() {
+    g_gammaRamp.reapply();
+    telemetry::set(telemetry::Counter::GammaUploads, g_gammaRamp.upload_count());
+}
+
+// Applies the command-line settings, which take precedence over the settings file.
+void apply_overrides_from_options(const cli::Options& options, settings::Values& values) {
+    if (options.brightness) values.grayLevel = *options.brightness;
+    if (options.kelvin) values.kelvin = *options.kelvin;
+    if (options.fps) values.frameDelayMs = std::max(1000u / static_cast<UINT>(*options.fps), 1u);
+    if (options.stallThresholdMs) values.stallThresholdMs = *options.stallThresholdMs;
+    if (options.batteryFrameDelayMs) values.batteryFrameDelayMs = static_cast<UINT>(*options.batteryFrameDelayMs);
+    if (options.footprintIntervalMs) values.footprintIntervalMs = static_cast<UINT>(*options.footprintIntervalMs);
+    if (options.cpuBudgetPermille) values.cpuBudgetPermille = *options.cpuBudgetPermille;
+}
+
+// Reads the settings file over the compiled defaults and applies the command-line
+// overrides. A missing file leaves the defaults; an invalid one is reported and
+// rejected as a whole, returning false with values untouched.
+bool LoadSettings(const cli::Options& options, settings::Values& values) {
+    settings::Values loaded;
+    std::string error;
+    switch (settings::load_file(g_configPath, loaded, error)) {
+    case settings::LoadResult::Loaded:
+        logMessage("Settings loaded from " + g_configPath);
+        break;
+    case settings::LoadResult::Missing:
+        break;
+    case settings::LoadResult::Invalid:
+        flight::record(flight::Event::SettingsRejected);
+        logMessage("Warning: Ignoring settings file " + g_configPath + ": " + error);
+        return false;
+    }
+    apply_overrides_from_options(options, loaded);
+    values = loaded;
+    return true;
+}
+
+// State for FindMonitorRect's enumeration callback.
+struct MonitorSearch {
+    int remaining; // Monitors still to skip before the requested one.
+    RECT rect;
+    bool found;
+};
+
+BOOL CALLBACK FindMonitorProc(HMONITOR, HDC, LPRECT monitorRect, LPARAM data) {
+    auto* search = reinterpret_cast<MonitorSearch*>(data);
+    if (search->remaining-- > 0) {
+        return TRUE;
+    }
+    search->rect = *monitorRect;
+    search->found = true;
+    return FALSE;
+}
+
+// Finds the rectangle of the index-th monitor, in EnumDisplayMonitors order.
+bool FindMonitorRect(int index, RECT& rect) {
+    MonitorSearch search = {index, {}, false};
+    EnumDisplayMonitors(NULL, NULL, FindMonitorProc, reinterpret_cast<LPARAM>(&search));
+    if (search.found) {
+        rect = search.rect;
+    }
+    return search.found;
+}
+
+// Restores the last session under the command line: options given for this run win,
+// anything else comes from the state file, then from the settings.
+void RestoreSession() {
+    session::State saved;
+    const bool restored = session::load(g_statePath, saved);
+    if (restored) {
+        logMessage("Session state restored from " + g_statePath);
+        g_session = saved;
+    } else {
+        g_session.grayLevel = g_settings.grayLevel;
+        g_session.kelvin = g_settings.kelvin;
+    }
+    if (g_options.brightness) {
+        g_session.grayLevel = *g_options.brightness;
+    }
+    if (g_options.kelvin) {
+        g_session.kelvin = color::clamp_kelvin(*g_options.kelvin);
+    }
+    if (g_options.motion || !restored) {
+        g_session.motionKind = g_motionKind;
+    } else {
+        g_motionKind = g_session.motionKind;
+    }
+    if (g_options.monitor) {
+        g_session.monitor = *g_options.monitor;
+    }
+    // Anything the command line changed is saved like any other change.
+    g_sessionWriter.start(g_statePath, restored ? saved : session::State{});
+    g_sessionWriter.submit(g_session);
+}
+
+// Records the light's state after a user action. Motion only follows the M key:
+// edge-light mode and --no-motion turn it off for one run without changing the saved choice.
+void PersistSession(const core::State& state, bool motionToggled) {
+    g_session.grayLevel = state.grayLevel;
+    g_session.kelvin = state.kelvin;
+    if (motionToggled) {
+        g_session.motionEnabled = state.motionEnabled;
+    }
+    g_sessionWriter.submit(g_session);
+}
+
+// Whether a key adjusts the light, so the HUD should show the result.
+bool IsAdjustmentKey(unsigned key) {
+    return key == core::kKeyUp || key == core::kKeyDown || key == core::kKeyLeft || key == core::kKeyRight
+        || key == core::kKeyM || key == core::kKeyWarmer || key == core::kKeyCooler;
+}
+
+// Whether the cursor moves from the start. Edge-light mode leaves the cursor to the user.
+bool MotionAtStartup() {
+    return !g_isEdgeLight && !g_options.noMotion && g_session.motionEnabled;
+}
+
+// Formats a stall record as a single log line with a local wall-clock timestamp.
+std::string FormatStallRecord(const StallRecord& record) {
+    const std::time_t startedAt = std::chrono::system_clock::to_time_t(record.startedAt);
+    std::tm local = {};
+    char timestamp[32] = "?";
+    if (localtime_s(&local, &startedAt) == 0) {
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &local);
     }
+    char message[16];
+    std::snprintf(message, sizeof(message), "0x%04X", record.message);
+    return std::string(timestamp) + " message " + message + " stalled the loop for "
+        + std::to_string(record.duration.count() / 1000) + "ms";
+}
+
+// Invoked on the watchdog thread; only reaches the console in verbose mode.
+void OnLoopStall(const StallRecord& record, bool ended) {
+    flight::record(flight::Event::Stall, ended ? 1 : 0,
+                   std::uint64_t{record.message} << 32 | static_cast<std::uint64_t>(record.duration.count() / 1000));
+    logMessage((ended ? "Stall ended: " : "Stall detected: ") + FormatStallRecord(record));
 }
 
 // Handles console control events (like Ctrl+C) for graceful shutdown in verbose mode.
 BOOL WINAPI ConsoleHandler(DWORD ctrlType) {
+    flight::record(flight::Event::ConsoleSignal, static_cast<std::uint16_t>(ctrlType));
     switch (ctrlType) {
     case CTRL_C_EVENT:
     case CTRL_BREAK_EVENT:
@@ -163,6 +871,9 @@ BOOL WINAPI ConsoleHandler(DWORD ctrlType) {
             // Post a message to the window's message queue to trigger a clean shutdown.
             // This is safer than calling DestroyWindow directly from this handler thread.
             PostMessage(g_hMainWnd, WM_APP_SHUTDOWN, 0, 0);
+        } else {
+            // --keep-awake-only has no window; its loop ends on WM_QUIT.
+            PostThreadMessage(g_mainThreadId, WM_QUIT, 0, 0);
         }
         // Give the main thread a moment to process the message before the process terminates.
         Sleep(1000);
@@ -171,34 +882,129 @@ BOOL WINAPI ConsoleHandler(DWORD ctrlType) {
     return FALSE; // We did not handle the event; pass it to the next handler.
 }
 
+// --keep-awake-only: holds the power request and nothing else. No window, motion
+// thread, settings watcher or watchdog is created; the thread sleeps in GetMessage
+// until the console handler posts WM_QUIT.
+int RunKeepAwakeOnly() {
+    if (SetThreadExecutionState(ES_CONTINUOUS | ES_SYSTEM_REQUIRED | ES_DISPLAY_REQUIRED)) {
+        logMessage("Keep-awake only: system and display will stay on. Press Ctrl+C to exit.");
+    } else {
+        logMessage("Warning: Could not inhibit power management.");
+    }
+    if (g_exitAfterStartup) {
+        PostThreadMessage(g_mainThreadId, WM_QUIT, 0, 0);
+    }
+    MSG msg = {};
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        DispatchMessage(&msg);
+    }
+    SetThreadExecutionState(ES_CONTINUOUS);
+    logMessage("Program terminated.");
+    flight::record(flight::Event::Exit, 0, static_cast<std::uint64_t>(msg.wParam));
+    flight::calibrate();
+    flight::close();
+    telemetry::close_publisher();
+    if (g_isVerbose) {
+        output::close_console();
+    }
+    return (int)msg.wParam;
+}
+
 // The application entry point. By using main(), we create a console application.
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
-    const auto args = ParseCommandLine();
-    setup_verbosity_from_args(args);
+    g_mainThreadId = GetCurrentThreadId();
+    cli::parse(GetCommandLineW(), g_options);
+    setup_from_options(g_options);
+    // Before any other thread exists, so every event lands in the mapped ring.
+    const bool flightRecording = flight::open(g_flightPath);
+    flight::record(flight::Event::Start, 0, GetCurrentProcessId());
 
     if (g_isVerbose) {
-        // Try to attach to the parent process's console. If that fails (e.g., launched
-        // from the GUI), allocate a new console for logging. This makes --verbose robust.
-        if (!AttachConsole(ATTACH_PARENT_PROCESS)) {
-            AllocConsole();
-        }
-        // Redirect standard streams to the newly available console using the secure freopen_s.
-        FILE* dummy;
-        freopen_s(&dummy, "CONOUT$", "w", stdout);
-        freopen_s(&dummy, "CONOUT$", "w", stderr);
-        std::ios::sync_with_stdio();
+        // Attach to (or allocate) a console for logging. This makes --verbose robust.
+        output::open_console();
         // Register our handler for console events like Ctrl+C.
         SetConsoleCtrlHandler(ConsoleHandler, TRUE);
     }
 
+    if (!flightRecording) {
+        logMessage("Warning: Could not map the flight recorder file " + g_flightPath);
+    }
+    if (!g_options.rejected.empty()) {
+        logMessage("Warning: Ignoring argument " + file_io::narrow(g_options.rejected) + " and any invalid ones after it.");
+    }
+
+    // Settings are loaded once here; afterwards the file is only re-read when it changes.
+    if (!LoadSettings(g_options, g_settings)) {
+        apply_overrides_from_options(g_options, g_settings);
+    }
+
+    // Publish health counters for external monitors. Failure only means nobody can scrape them.
+    if (telemetry::open_publisher()) {
+        logMessage("Telemetry published to shared memory.");
+    } else {
+        logMessage("Warning: Could not publish telemetry (another instance may own it).");
+    }
+
+    RecoverGammaRamp();
+
+    if (g_options.keepAwakeOnly) {
+        return RunKeepAwakeOnly();
+    }
+
+    if (!g_configWatcher.start(g_configPath)) {
+        logMessage("Warning: Could not watch the settings file for changes.");
+    }
+    if (!g_options.ambientSpec.empty()) {
+        std::string error;
+        g_ambientSource = ambient::open_source(file_io::narrow(g_options.ambientSpec), error);
+        if (g_ambientSource) {
+            logMessage("Following ambient light from " + file_io::narrow(g_options.ambientSpec));
+        } else {
+            logMessage("Warning: Ignoring --ambient: " + error);
+        }
+    }
+    if (!g_options.schedulePath.empty()) {
+        std::string error;
+        if (schedule::load_file(file_io::narrow(g_options.schedulePath), g_schedule, error)) {
+            logMessage("Following the schedule in " + file_io::narrow(g_options.schedulePath) + " ("
+                + std::to_string(g_schedule.size()) + " keyframes)");
+        } else {
+            logMessage("Warning: Ignoring --schedule: " + error);
+        }
+    }
+    // Read before the window class exists, so the first paint is already the final colour.
+    RestoreSession();
+
+    // The light covers the primary screen, or the last or --monitor=K monitor. Motion
+    // stays on that monitor unless --bounds says otherwise.
+    RECT surface = {0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)};
+    if (g_session.monitor >= 0) {
+        if (FindMonitorRect(g_session.monitor, surface)) {
+            if (!g_options.bounds) {
+                g_boundsKind = BoundsKind::SubRect;
+                g_boundsRect = {static_cast<int>(surface.left), static_cast<int>(surface.top),
+                                static_cast<int>(surface.right), static_cast<int>(surface.bottom)};
+            }
+        } else {
+            logMessage("Warning: No monitor " + std::to_string(g_session.monitor) + "; using the primary screen.");
+        }
+    }
+
     const wchar_t CLASS_NAME[] = L"ScreenLightWindowClass";
 
-    const BYTE initialGrayLevel = 255; // Start with a full white screen.
-    HBRUSH hInitialBrush = CreateSolidBrush(RGB(initialGrayLevel, initialGrayLevel, initialGrayLevel));
+    const BYTE initialGrayLevel = static_cast<BYTE>(g_session.grayLevel); // A full white screen by default.
+    const color::Rgb initialColor = color::light_color(initialGrayLevel, g_session.kelvin);
+    const core::Light initialLight{initialGrayLevel, 0, g_session.kelvin, initialColor, initialColor};
+    // A light shown through the gamma ramp is painted white.
+    const bool gammaShowing = g_options.gammaRamp && StartGammaRamp(surface, initialLight);
+    HBRUSH hInitialBrush = gammaShowing ? CreateSolidBrush(RGB(255, 255, 255))
+                                        : CreateSolidBrush(RGB(initialColor.r, initialColor.g, initialColor.b));
     if (!hInitialBrush) {
         MessageBox(NULL, L"Could not create initial background brush.", L"Startup Error", MB_OK | MB_ICONERROR);
         return EXIT_FAILURE;
     }
+    telemetry::set(telemetry::Counter::Brightness, initialGrayLevel);
+    telemetry::set(telemetry::Counter::ColorTemperatureK, static_cast<std::uint64_t>(g_session.kelvin));
 
     WNDCLASSEX wc = {};
     wc.cbSize = sizeof(WNDCLASSEX);
@@ -216,12 +1022,32 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
         return EXIT_FAILURE;
     }
 
+    // Start recording before the window exists so the stream is complete from WM_CREATE on.
+    if (!g_recordPath.empty()) {
+        recording::FileHeader header;
+        header.frameDelayMs = g_settings.frameDelayMs;
+        header.surfaceWidth = static_cast<std::uint32_t>(surface.right - surface.left);
+        header.surfaceHeight = static_cast<std::uint32_t>(surface.bottom - surface.top);
+        header.grayLevel = initialGrayLevel;
+        header.kelvin = static_cast<std::uint16_t>(g_session.kelvin);
+        header.edgeBandWidth = g_settings.edgeBandWidth;
+        header.edgeLight = g_isEdgeLight ? 1 : 0;
+        header.motionEnabled = MotionAtStartup() ? 1 : 0;
+        if (g_recorder.open(g_recordPath, header)) {
+            logMessage("Recording messages to " + g_recordPath);
+        } else {
+            logMessage("Warning: Could not open recording file " + g_recordPath);
+        }
+    }
+
+    // In edge-light mode the window floats above other applications so the band stays
+    // visible while the user works in the click-through centre.
     HWND hwnd = CreateWindowEx(
-        0,
+        g_isEdgeLight ? (WS_EX_TOPMOST | WS_EX_TOOLWINDOW) : 0,
         CLASS_NAME,
         L"Screen Light",
         WS_POPUP,
-        0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN),
+        surface.left, surface.top, surface.right - surface.left, surface.bottom - surface.top,
         NULL,
         NULL,
         hInstance,
@@ -238,6 +1064,24 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
     ShowWindow(hwnd, SW_SHOWDEFAULT);
     UpdateWindow(hwnd);
 
+    // The first frame is up; pages only startup touched can go back to the system.
+    if (g_trimAfterStartup) {
+        const footprint::Sample before = footprint::take_sample();
+        if (footprint::trim_working_set()) {
+            logMessage("Trimmed working set after the first frame: " + footprint::describe(before)
+                + " -> " + footprint::describe(footprint::take_sample()));
+        } else {
+            logMessage("Warning: Could not trim the working set.");
+        }
+    }
+    footprint::publish(footprint::take_sample());
+    flight::calibrate();
+
+    if (g_exitAfterStartup) {
+        // The first frame has been painted; close through the normal shutdown path.
+        PostMessage(hwnd, WM_CLOSE, 0, 0);
+    }
+
     // Prevent the system from sleeping or turning off the display. This is the correct
     // way to keep the screen on, replacing the unreliable mouse-moving method.
     std::string message;
@@ -249,36 +1093,137 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
 
     logMessage(message);
 
-    // Standard message loop. GetMessage is more efficient than PeekMessage
-    // as it yields the CPU until a message is available.
+    // Watch the message loop from a separate thread so stalls are caught while they happen.
+    const std::chrono::milliseconds stallThreshold{g_settings.stallThresholdMs};
+    g_watchdog.start(stallThreshold, OnLoopStall);
+
+    // Message loop. The thread sleeps in MsgWaitForMultipleObjectsEx until a message
+    // arrives, the settings file changes or the ambient source has readings, so none of
+    // them is ever polled.
+    // Each dispatch is timed so the longest loop stall is visible to monitors, and
+    // stamped as the watchdog heartbeat. Waiting for messages is not a stall.
     MSG msg = {};
-    while (GetMessage(&msg, NULL, 0, 0) > 0) {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
+    bool running = true;
+    while (running) {
+        HANDLE handles[2];
+        DWORD handleCount = 0;
+        const HANDLE configChanged = g_configWatcher.wait_handle();
+        if (configChanged) handles[handleCount++] = configChanged;
+        const DWORD ambientIndex = handleCount;
+        if (g_ambientListening) handles[handleCount++] = g_ambientSource->wait_handle();
+        const DWORD wait = MsgWaitForMultipleObjectsEx(handleCount, handles, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        telemetry::add(telemetry::Counter::LoopWakeups);
+        if (configChanged && wait == WAIT_OBJECT_0) {
+            settings::Values next;
+            if (g_configWatcher.consume_change() && LoadSettings(g_options, next) && next != g_settings) {
+                SendMessage(hwnd, WM_APP_SETTINGS, 0, reinterpret_cast<LPARAM>(&next));
+            }
+            continue;
+        }
+        if (g_ambientListening && wait == WAIT_OBJECT_0 + ambientIndex) {
+            SendMessage(hwnd, WM_APP_AMBIENT, 0, 0);
+            continue;
+        }
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                running = false;
+                break;
+            }
+            const auto dispatchStart = std::chrono::steady_clock::now();
+            g_watchdog.begin_dispatch(msg.message, dispatchStart);
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+            g_watchdog.end_dispatch();
+            const auto stall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - dispatchStart);
+            telemetry::raise(telemetry::Counter::LoopStallMaxUs, static_cast<std::uint64_t>(stall.count()));
+        }
     }
+    g_configWatcher.stop();
 
-    // Restore the system's normal power-saving behavior before exiting.
+    // Restore the system's normal power-saving behavior and the display's own ramp before exiting.
     SetThreadExecutionState(ES_CONTINUOUS);
+    g_gammaRamp.restore();
+
+    g_watchdog.stop();
+    logMessage("Watchdog: " + std::to_string(g_watchdog.stall_count()) + " stall(s) over "
+        + std::to_string(stallThreshold.count()) + "ms, longest "
+        + std::to_string(g_watchdog.max_stall().count() / 1000) + "ms.");
+    g_watchdog.for_each_record([](const StallRecord& record) {
+        logMessage("  " + FormatStallRecord(record));
+    });
     logMessage("Program terminated.");
 
+    g_recorder.close();
+    g_sessionWriter.stop(); // Writes a change still inside its debounce delay.
+    flight::record(flight::Event::Exit, 0, static_cast<std::uint64_t>(msg.wParam));
+    flight::calibrate();
+    flight::close();
+    telemetry::close_publisher();
+
     // If we created a console, free it before exiting.
     if (g_isVerbose) {
-        FreeConsole();
+        output::close_console();
     }
 
     return (int)msg.wParam;
 }
 
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-    // A static instance of MouseMover, created on the first call to WndProc.
+    // Cursor motion runs on its own thread; the UI thread only toggles and reschedules it.
     // It persists for the lifetime of the application.
-    static MouseMover mover;
+    static MotionThread motion;
+    // Pauses or slows motion and painting according to power, display and session state.
+    static PowerScheduler power;
+    // Key handling lives in the platform-independent core, which drives the window through the backend.
+    static Win32Backend backend(motion, power);
+    static core::LightCore light(backend);
+    // Shows the level after each adjustment.
+    static Hud hud;
+
+    if (g_recorder.is_open()) {
+        const bool shift = msg == WM_KEYDOWN && (GetKeyState(VK_SHIFT) & 0x8000);
+        g_recorder.record(msg, wParam, shift ? core::kModifierShift : 0, std::chrono::steady_clock::now());
+    }
 
     switch (msg) {
     case WM_CREATE:
-        // Set a timer to fire periodically, triggering mouse movement.
-        // This is more efficient than a busy-wait loop.
-        SetTimer(hwnd, IDT_MOUSEMOVE_TIMER, config::kFrameDelayMs, NULL);
+        {
+            backend.attach(hwnd);
+            g_timelineTimer.attach(hwnd);
+            RECT rc;
+            GetClientRect(hwnd, &rc);
+            core::State state;
+            state.grayLevel = g_session.grayLevel;
+            state.kelvin = g_session.kelvin;
+            state.dither = g_options.dither;
+            state.edgeBandWidth = g_settings.edgeBandWidth;
+            state.edgeLight = g_isEdgeLight;
+            state.motionEnabled = MotionAtStartup();
+            state.surfaceWidth = rc.right - rc.left;
+            state.surfaceHeight = rc.bottom - rc.top;
+            light.configure(state);
+        }
+        // Start the motion thread, which wakes periodically to move the cursor.
+        // This is more efficient than a busy-wait loop. Power notifications then
+        // pause it or slow it down as the system's state changes.
+        if (g_isEdgeLight) {
+            ApplyEdgeBandRegion(hwnd, g_settings.edgeBandWidth);
+        }
+        if (MotionAtStartup()) {
+            StartMotionThread(motion, power);
+        }
+        power.register_notifications(hwnd);
+        if (!hud.create(hwnd, g_timeline)) {
+            logMessage("Warning: Could not create the HUD.");
+        }
+        RestartAmbient(power, light);
+        RestartSchedule(light);
+        RestartGovernor(power, motion, hud);
+        RestartFootprint(power);
+        if (!g_options.noHotKeys) {
+            RegisterHotKeys(hwnd);
+        }
+        PublishGdiHandleCount();
         return EXIT_SUCCESS;
 
     case WM_APP_SHUTDOWN:
@@ -289,9 +1234,23 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
     case WM_DESTROY:
         {
+            flight::record(flight::Event::WindowDestroyed);
             // Ensure the cursor is visible again when the application closes.
             ShowCursor(TRUE);
-            KillTimer(hwnd, IDT_MOUSEMOVE_TIMER);
+            if (motion.is_running()) {
+                motion.stop();
+                logMessage("Motion: " + std::to_string(motion.tick_count()) + " ticks, timer jitter mean "
+                    + std::to_string(motion.mean_jitter().count()) + "us, max "
+                    + std::to_string(motion.max_jitter().count()) + "us"
+                    + (motion.is_high_resolution() ? " (high-resolution timer)." : " (standard timer)."));
+            }
+            power.unregister_notifications(hwnd);
+            if (!g_options.noHotKeys) {
+                UnregisterHotKeys(hwnd);
+            }
+            hud.destroy();
+            g_timeline.clear();
+            logMessage("Footprint at exit: " + footprint::describe(footprint::take_sample()));
             HBRUSH hBrush = (HBRUSH)GetClassLongPtr(hwnd, GCLP_HBRBACKGROUND);
             if (hBrush) {
                 DeleteObject(hBrush);
@@ -300,30 +1259,105 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         PostQuitMessage(0);
         return EXIT_SUCCESS;
 
+    case WM_PAINT:
+        if (power.is_paused()) {
+            // Nobody can see the light; validate without drawing and repaint on resume.
+            ValidateRect(hwnd, NULL);
+            power.mark_paint_skipped();
+            return EXIT_SUCCESS;
+        }
+        // Painting itself is left to the default handler and the class brush, with the
+        // HUD composed over it while visible.
+        telemetry::add(telemetry::Counter::Repaints);
+        if (hud.is_visible()) {
+            PAINTSTRUCT ps;
+            HDC hdc = BeginPaint(hwnd, &ps);
+            hud.paint(hdc, ps.rcPaint);
+            EndPaint(hwnd, &ps);
+            return EXIT_SUCCESS;
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+
+    case WM_ERASEBKGND:
+        if (hud.is_visible()) {
+            // Erase around the HUD only, then give the paint DC its full clip back.
+            HDC hdc = reinterpret_cast<HDC>(wParam);
+            const int saved = SaveDC(hdc);
+            hud.exclude_from(hdc);
+            const LRESULT erased = DefWindowProc(hwnd, msg, wParam, lParam);
+            RestoreDC(hdc, saved);
+            return erased;
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+
+    case WM_APP_SETTINGS:
+        ApplySettings(*reinterpret_cast<const settings::Values*>(lParam), power, motion, light, hud);
+        PersistSession(light.state(), false);
+        return EXIT_SUCCESS;
+
+    case WM_APP_AMBIENT:
+        ReadAmbient(light);
+        return EXIT_SUCCESS;
+
+    case WM_TIMER:
+        if (wParam == IDT_TIMELINE) {
+            g_timeline.run_due(timeline::Clock::now());
+            return EXIT_SUCCESS;
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+
+    case WM_POWERBROADCAST:
+        flight::record(flight::Event::PowerBroadcast, static_cast<std::uint16_t>(wParam));
+        if (wParam == PBT_APMRESUMEAUTOMATIC) {
+            RestartSchedule(light);
+            ReapplyGammaRamp(); // Resume resets the ramp.
+        }
+        if (power.on_power_broadcast(wParam, lParam)) {
+            OnPowerScheduleChanged(hwnd, power, motion, hud, light);
+        }
+        return TRUE;
+
+    case WM_WTSSESSION_CHANGE:
+        flight::record(flight::Event::SessionChange, static_cast<std::uint16_t>(wParam));
+        if (wParam == WTS_SESSION_UNLOCK) {
+            ReapplyGammaRamp(); // The secure desktop may have reset the ramp.
+        }
+        if (power.on_session_change(wParam)) {
+            OnPowerScheduleChanged(hwnd, power, motion, hud, light);
+        }
+        return EXIT_SUCCESS;
+
+    case WM_TIMECHANGE:
+        RestartSchedule(light);
+        return EXIT_SUCCESS;
+
+    case WM_DISPLAYCHANGE:
+        ReapplyGammaRamp(); // A mode change resets the ramp to identity.
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+
     case WM_KEYDOWN:
         {
-            const int step = (GetKeyState(VK_SHIFT) & 0x8000) ? 1 : 10;
-            switch (wParam) {
-                case VK_ESCAPE:
-                    DestroyWindow(hwnd);
-                    break;
-                case VK_UP:
-                    UpdateBackgroundColor(hwnd, true, step);
-                    break;
-                case VK_DOWN:
-                    UpdateBackgroundColor(hwnd, false, step);
-                    break;
-                case 'M': // Toggle mouse movement
-                    mover.toggle(); // Toggle the movement state...
-                    ShowCursor(mover.is_enabled()); // ...and sync cursor visibility with it.
-                    break;
+            telemetry::add(telemetry::Counter::KeyEvents);
+            const bool shift = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
+            flight::record(flight::Event::KeyDown, static_cast<std::uint16_t>(wParam), shift ? core::kModifierShift : 0);
+            const bool motionBefore = light.state().motionEnabled;
+            light.handle_key(static_cast<unsigned>(wParam), shift ? core::kModifierShift : 0);
+            PersistSession(light.state(), light.state().motionEnabled != motionBefore);
+            if (IsAdjustmentKey(static_cast<unsigned>(wParam))) {
+                hud.show(light.state(), g_gammaRamp.is_showing());
             }
         }
         return EXIT_SUCCESS;
 
-    case WM_TIMER:
-        if (wParam == IDT_MOUSEMOVE_TIMER && mover.is_enabled()) {
-            mover.update();
+    case WM_HOTKEY:
+        {
+            // The same path as a local key, so repaints coalesce exactly as they do for keys.
+            telemetry::add(telemetry::Counter::KeyEvents);
+            flight::record(flight::Event::HotKey, static_cast<std::uint16_t>(wParam));
+            const bool motionBefore = light.state().motionEnabled;
+            light.handle_hotkey(static_cast<unsigned>(wParam));
+            PersistSession(light.state(), light.state().motionEnabled != motionBefore);
+            hud.show(light.state(), g_gammaRamp.is_showing());
         }
         return EXIT_SUCCESS;
 
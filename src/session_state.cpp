@@ -0,0 +1,134 @@
+#include "session_state.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "color_temperature.h"
+#include "file_io.h"
+#include "log.h"
+
+namespace session {
+
+namespace {
+    std::uint32_t checksum_of(const FileImage& image) {
+        std::uint32_t hash = 2166136261u;
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&image);
+        for (std::size_t i = 0; i < offsetof(FileImage, checksum); ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+}
+
+bool load(const std::string& utf8Path, State& state) {
+    std::FILE* file = file_io::open_file(utf8Path, false);
+    if (!file) {
+        return false;
+    }
+    FileImage image;
+    const bool read = std::fread(&image, sizeof(image), 1, file) == 1;
+    std::fclose(file);
+    if (!read || image.magic != kMagic || image.version != kVersion || image.size != sizeof(FileImage)
+        || image.checksum != checksum_of(image)) {
+        return false;
+    }
+    if (image.grayLevel < 0 || image.grayLevel > 255 || image.motionKind > static_cast<std::uint8_t>(MotionKind::IdleNudge)) {
+        return false;
+    }
+    state.grayLevel = image.grayLevel;
+    state.kelvin = image.kelvin != 0 ? color::clamp_kelvin(image.kelvin) : config::kNeutralKelvin;
+    state.motionEnabled = image.motionEnabled != 0;
+    state.motionKind = static_cast<MotionKind>(image.motionKind);
+    state.monitor = image.monitor;
+    return true;
+}
+
+bool save(const std::string& utf8Path, const State& state) {
+    FileImage image;
+    image.grayLevel = static_cast<std::int16_t>(state.grayLevel);
+    image.kelvin = static_cast<std::uint16_t>(state.kelvin);
+    image.motionEnabled = state.motionEnabled ? 1 : 0;
+    image.motionKind = static_cast<std::uint8_t>(state.motionKind);
+    image.monitor = static_cast<std::int16_t>(state.monitor);
+    image.checksum = checksum_of(image);
+
+    // Write a sibling file and rename it over the old one, so a crash mid-write never
+    // leaves a torn state file behind.
+    const std::string temporary = utf8Path + ".tmp";
+    std::FILE* file = file_io::open_file(temporary, true);
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(&image, sizeof(image), 1, file) == 1;
+    if (std::fclose(file) != 0 || !written) {
+        file_io::remove_file(temporary);
+        return false;
+    }
+    return file_io::replace_file(temporary, utf8Path);
+}
+
+void Writer::start(const std::string& utf8Path, const State& saved) {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_path = utf8Path;
+    m_submitted = saved;
+    m_pending = false;
+    m_stopRequested = false;
+    m_thread = std::thread(&Writer::run, this);
+}
+
+void Writer::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void Writer::submit(const State& state) {
+    if (!m_thread.joinable() || state == m_submitted) {
+        return;
+    }
+    m_submitted = state;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_next = state;
+        m_pending = true;
+        m_deadline = std::chrono::steady_clock::now() + kDebounce;
+    }
+    m_wake.notify_one();
+}
+
+void Writer::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        if (!m_pending) {
+            m_wake.wait(lock, [this] { return m_pending || m_stopRequested; });
+        } else {
+            // Each submit pushes the deadline back, so only the last state of a burst is written.
+            m_wake.wait_until(lock, m_deadline, [this] { return m_stopRequested; });
+        }
+        const bool due = m_pending && (m_stopRequested || std::chrono::steady_clock::now() >= m_deadline);
+        if (due) {
+            const State state = m_next;
+            m_pending = false;
+            // Write unlocked so submit() never waits for the disk.
+            lock.unlock();
+            if (!save(m_path, state)) {
+                logMessage("Warning: Could not save the session state to " + m_path);
+            }
+            lock.lock();
+        }
+        if (m_stopRequested && !m_pending) {
+            return;
+        }
+    }
+}
+
+} // namespace session
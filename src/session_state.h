@@ -0,0 +1,88 @@
+#pragma once
+
+// The last-used brightness, motion mode and monitor, kept in a tiny fixed-layout file so
+// the next launch can paint its first frame at the final colour. The file is one
+// FileImage; multi-byte fields are stored in the host's (little-endian) byte order, as in
+// recordings. A file that is short, from another version or fails its checksum is ignored.
+//
+// Writes happen on a background thread and are debounced: a burst of key presses costs
+// one small write after the keys stop, and the UI thread never waits for the disk.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "config.h"
+#include "mouse_mover.h" // For MotionKind
+
+namespace session {
+
+constexpr std::uint32_t kMagic = 0x54534C53; // "SLST" in little-endian memory order.
+constexpr std::uint16_t kVersion = 1;
+
+// What is restored at startup. monitor is -1 for the primary screen.
+struct State {
+    int grayLevel = config::kInitialGrayLevel;
+    int kelvin = config::kNeutralKelvin;
+    bool motionEnabled = true;
+    MotionKind motionKind = MotionKind::Bounce;
+    int monitor = -1;
+
+    bool operator==(const State&) const = default;
+};
+
+struct FileImage {
+    std::uint32_t magic = kMagic;
+    std::uint16_t version = kVersion;
+    std::uint16_t size = sizeof(FileImage);
+    std::int16_t grayLevel = 0;
+    std::uint8_t motionEnabled = 0;
+    std::uint8_t motionKind = 0;
+    std::int16_t monitor = -1;
+    std::uint16_t kelvin = 0; // 0 (files written before it existed) is neutral.
+    std::uint32_t checksum = 0; // FNV-1a of the bytes before it.
+};
+static_assert(sizeof(FileImage) == 20, "Session state layout must not change silently");
+
+// Reads the state file. Returns false, leaving state untouched, if it is missing or invalid.
+bool load(const std::string& utf8Path, State& state);
+
+// Writes the state file now, replacing the previous one only once the new one is complete.
+bool save(const std::string& utf8Path, const State& state);
+
+// Saves submitted states on a background thread, once no new state has arrived for the
+// debounce delay. stop() writes any pending state before returning.
+class Writer {
+public:
+    static constexpr std::chrono::milliseconds kDebounce{1500};
+
+    Writer() = default;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer() { stop(); }
+
+    // Starts the writer. saved is the state already on disk, so submitting it again is free.
+    void start(const std::string& utf8Path, const State& saved);
+    void stop();
+
+    // Queues a state for writing. Only the UI thread calls this; it never blocks on I/O.
+    void submit(const State& state);
+
+private:
+    void run();
+
+    std::string m_path;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopRequested = false;
+    bool m_pending = false;
+    State m_next;                                     // Guarded by m_mutex.
+    std::chrono::steady_clock::time_point m_deadline; // Guarded by m_mutex.
+    State m_submitted; // The last state passed to submit(); only the UI thread touches it.
+};
+
+} // namespace session
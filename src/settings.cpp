@@ -0,0 +1,281 @@
+#include "settings.h"
+
+#include <charconv>
+#include <cstdio>
+
+#include "file_io.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>       // For O_NONBLOCK
+#include <sys/inotify.h> // For inotify_init1 and inotify_add_watch
+#include <unistd.h>      // For read and close
+#endif
+
+namespace settings {
+
+namespace {
+    // Settings files are a few lines; anything larger is not one.
+    constexpr std::size_t kMaxFileSize = 64 * 1024;
+
+    struct Field {
+        std::string_view key;
+        long long minimum;
+        long long maximum;
+        void (*assign)(Values& values, long long value);
+    };
+
+    constexpr Field kFields[] = {
+        {"brightness", 0, 255, [](Values& v, long long x) { v.grayLevel = static_cast<int>(x); }},
+        {"color_temperature", config::kMinKelvin, config::kMaxKelvin, [](Values& v, long long x) { v.kelvin = static_cast<int>(x); }},
+        {"initial_x", 0, 1 << 20, [](Values& v, long long x) { v.initialX = static_cast<int>(x); }},
+        {"initial_y", 0, 1 << 20, [](Values& v, long long x) { v.initialY = static_cast<int>(x); }},
+        {"velocity", 1, 1000, [](Values& v, long long x) { v.velocity = static_cast<int>(x); }},
+        {"frame_delay_ms", 1, 10000, [](Values& v, long long x) { v.frameDelayMs = static_cast<unsigned int>(x); }},
+        {"battery_frame_delay_ms", 1, 10000, [](Values& v, long long x) { v.batteryFrameDelayMs = static_cast<unsigned int>(x); }},
+        {"edge_band_width", config::kEdgeBandMin, 1 << 15, [](Values& v, long long x) { v.edgeBandWidth = static_cast<int>(x); }},
+        {"stall_threshold_ms", 1, 600000, [](Values& v, long long x) { v.stallThresholdMs = static_cast<int>(x); }},
+        {"footprint_interval_ms", 100, 86400000, [](Values& v, long long x) { v.footprintIntervalMs = static_cast<unsigned int>(x); }},
+        {"cpu_budget_permille", 0, 1000, [](Values& v, long long x) { v.cpuBudgetPermille = static_cast<int>(x); }},
+    };
+
+    std::string_view trim(std::string_view text) {
+        constexpr std::string_view kSpace = " \t\r";
+        const std::size_t first = text.find_first_not_of(kSpace);
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(kSpace) - first + 1);
+    }
+}
+
+bool parse(std::string_view text, Values& values, std::string& error) {
+    Values parsed = values;
+    int lineNumber = 0;
+    while (!text.empty()) {
+        const std::size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        ++lineNumber;
+
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        const std::size_t equals = line.find('=');
+        if (equals == std::string_view::npos) {
+            error = "line " + std::to_string(lineNumber) + ": expected key = value";
+            return false;
+        }
+        const std::string_view key = trim(line.substr(0, equals));
+        const std::string_view valueText = trim(line.substr(equals + 1));
+
+        const Field* field = nullptr;
+        for (const Field& candidate : kFields) {
+            if (candidate.key == key) {
+                field = &candidate;
+                break;
+            }
+        }
+        if (!field) {
+            error = "line " + std::to_string(lineNumber) + ": unknown key '" + std::string(key) + "'";
+            return false;
+        }
+        long long value = 0;
+        const char* last = valueText.data() + valueText.size();
+        const auto [ptr, ec] = std::from_chars(valueText.data(), last, value);
+        if (ec != std::errc() || ptr != last || valueText.empty()) {
+            error = "line " + std::to_string(lineNumber) + ": '" + std::string(key) + "' needs an integer";
+            return false;
+        }
+        if (value < field->minimum || value > field->maximum) {
+            error = "line " + std::to_string(lineNumber) + ": '" + std::string(key) + "' must be between "
+                + std::to_string(field->minimum) + " and " + std::to_string(field->maximum);
+            return false;
+        }
+        field->assign(parsed, value);
+    }
+    values = parsed;
+    return true;
+}
+
+LoadResult load_file(const std::string& utf8Path, Values& values, std::string& error) {
+    std::FILE* file = file_io::open_file(utf8Path, false);
+    if (!file) {
+        return LoadResult::Missing;
+    }
+    std::string text;
+    char buffer[4096];
+    std::size_t read = 0;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0 && text.size() <= kMaxFileSize) {
+        text.append(buffer, read);
+    }
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed || text.size() > kMaxFileSize) {
+        error = failed ? "could not read the file" : "the file is too large";
+        return LoadResult::Invalid;
+    }
+    return parse(text, values, error) ? LoadResult::Loaded : LoadResult::Invalid;
+}
+
+#ifdef _WIN32
+
+struct FileWatcher::Impl {
+    HANDLE directory = INVALID_HANDLE_VALUE;
+    HANDLE event = NULL;
+    OVERLAPPED overlapped = {};
+    std::wstring fileName;
+    // ReadDirectoryChangesW requires a DWORD-aligned buffer.
+    alignas(DWORD) BYTE buffer[4096];
+
+    bool arm() {
+        overlapped = {};
+        overlapped.hEvent = event;
+        return ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE,
+                                     FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+                                     NULL, &overlapped, NULL) != FALSE;
+    }
+};
+
+bool FileWatcher::start(const std::string& utf8Path) {
+    stop();
+    const std::wstring path = file_io::widen(utf8Path);
+    if (path.empty()) {
+        return false;
+    }
+
+    const std::size_t slash = path.find_last_of(L"\\/");
+    const std::wstring directory = slash == std::wstring::npos ? std::wstring(L".") : path.substr(0, slash + 1);
+    auto impl = std::make_unique<Impl>();
+    impl->fileName = slash == std::wstring::npos ? path : path.substr(slash + 1);
+    impl->directory = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                                  FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (impl->directory == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    impl->event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!impl->event || !impl->arm()) {
+        if (impl->event) CloseHandle(impl->event);
+        CloseHandle(impl->directory);
+        return false;
+    }
+    m_impl = std::move(impl);
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (!m_impl) {
+        return;
+    }
+    // Cancel the pending read and wait for it, since the kernel writes into our buffer.
+    CancelIoEx(m_impl->directory, &m_impl->overlapped);
+    DWORD bytes = 0;
+    GetOverlappedResult(m_impl->directory, &m_impl->overlapped, &bytes, TRUE);
+    CloseHandle(m_impl->directory);
+    CloseHandle(m_impl->event);
+    m_impl.reset();
+}
+
+FileWatcher::WaitHandle FileWatcher::wait_handle() const {
+    return m_impl ? m_impl->event : NULL;
+}
+
+bool FileWatcher::consume_change() {
+    if (!m_impl) {
+        return false;
+    }
+    DWORD bytes = 0;
+    const bool completed = GetOverlappedResult(m_impl->directory, &m_impl->overlapped, &bytes, FALSE) != FALSE;
+    ResetEvent(m_impl->event);
+    // Zero bytes means the change list overflowed, so the file may be among the lost entries.
+    bool changed = !completed || bytes == 0;
+    for (DWORD offset = 0; completed && !changed && offset < bytes;) {
+        const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(m_impl->buffer + offset);
+        const int nameLength = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+        changed = CompareStringOrdinal(info->FileName, nameLength, m_impl->fileName.c_str(),
+                                       static_cast<int>(m_impl->fileName.size()), TRUE) == CSTR_EQUAL;
+        if (info->NextEntryOffset == 0) {
+            break;
+        }
+        offset += info->NextEntryOffset;
+    }
+    if (!m_impl->arm()) {
+        stop();
+    }
+    return changed;
+}
+
+#else
+
+struct FileWatcher::Impl {
+    int fd = -1;
+    std::string fileName;
+};
+
+bool FileWatcher::start(const std::string& utf8Path) {
+    stop();
+    const std::size_t slash = utf8Path.rfind('/');
+    const std::string directory = slash == std::string::npos ? std::string(".") : utf8Path.substr(0, slash + 1);
+    auto impl = std::make_unique<Impl>();
+    impl->fileName = slash == std::string::npos ? utf8Path : utf8Path.substr(slash + 1);
+    impl->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (impl->fd < 0) {
+        return false;
+    }
+    // Editors often save by renaming a temporary file over the original, hence IN_MOVED_TO.
+    if (inotify_add_watch(impl->fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(impl->fd);
+        return false;
+    }
+    m_impl = std::move(impl);
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (!m_impl) {
+        return;
+    }
+    close(m_impl->fd);
+    m_impl.reset();
+}
+
+FileWatcher::WaitHandle FileWatcher::wait_handle() const {
+    return m_impl ? m_impl->fd : -1;
+}
+
+bool FileWatcher::consume_change() {
+    if (!m_impl) {
+        return false;
+    }
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length = 0;
+    while ((length = read(m_impl->fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && m_impl->fileName == event->name)) {
+                changed = true;
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+    return changed;
+}
+
+#endif
+
+FileWatcher::FileWatcher() = default;
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::is_watching() const {
+    return m_impl != nullptr;
+}
+
+} // namespace settings
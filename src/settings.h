@@ -0,0 +1,82 @@
+#pragma once
+
+// Site settings read from a small text file, so the tick rate, speed or brightness
+// can change without a rebuild. The file holds "key = value" lines; '#' starts a
+// comment and unknown keys are errors. The compiled constants in config.h remain
+// the defaults for anything the file leaves out.
+//
+// A file is applied all or nothing: parsing fills a fresh Values and only a fully
+// valid file replaces the running ones. The application caches the result in plain
+// variables, so code that reads settings pays nothing for the file existing.
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "config.h"
+
+namespace settings {
+
+struct Values {
+    int grayLevel = config::kInitialGrayLevel;                         // brightness
+    int kelvin = config::kNeutralKelvin;                               // color_temperature
+    int initialX = config::kInitialX;                                  // initial_x (startup only), from the motion area's left
+    int initialY = config::kInitialY;                                  // initial_y (startup only), from the motion area's top
+    int velocity = config::kVelocity;                                  // velocity
+    unsigned int frameDelayMs = config::kFrameDelayMs;                 // frame_delay_ms
+    unsigned int batteryFrameDelayMs = config::kBatteryFrameDelayMs;   // battery_frame_delay_ms
+    int edgeBandWidth = config::kEdgeBandWidth;                        // edge_band_width
+    int stallThresholdMs = config::kStallThresholdMs;                  // stall_threshold_ms (startup only)
+    unsigned int footprintIntervalMs = config::kFootprintIntervalMs;   // footprint_interval_ms
+    int cpuBudgetPermille = config::kCpuBudgetPermille;                // cpu_budget_permille (0 = unlimited)
+
+    bool operator==(const Values&) const = default;
+};
+
+enum class LoadResult {
+    Loaded,
+    Missing, // No file at the path; the values are left as they were.
+    Invalid, // The file could not be read or has a bad line; the values are left as they were.
+};
+
+// Parses the text of a settings file over the given values. On failure, returns false
+// with a description of the first bad line in error and leaves values untouched.
+bool parse(std::string_view text, Values& values, std::string& error);
+
+// Reads and parses the file at a UTF-8 path.
+LoadResult load_file(const std::string& utf8Path, Values& values, std::string& error);
+
+// Waits for changes to one file by watching its directory (ReadDirectoryChangesW on
+// Windows, inotify elsewhere), so changes are noticed without ever polling. The wait
+// handle goes into the owner's main wait; when it is signalled, consume_change()
+// re-arms the watch and reports whether the watched file was among the changes.
+class FileWatcher {
+public:
+#ifdef _WIN32
+    using WaitHandle = void*; // An event HANDLE.
+#else
+    using WaitHandle = int;   // A readable file descriptor.
+#endif
+
+    FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    ~FileWatcher();
+
+    // Starts watching the file at a UTF-8 path, which does not need to exist yet.
+    bool start(const std::string& utf8Path);
+    void stop();
+    [[nodiscard]] bool is_watching() const;
+
+    [[nodiscard]] WaitHandle wait_handle() const;
+
+    // Call once the wait handle is signalled. Returns true if the watched file may have
+    // changed (including when the change list overflowed), false for other files.
+    bool consume_change();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace settings
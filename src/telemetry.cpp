@@ -0,0 +1,213 @@
+#include "telemetry.h"
+
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>    // For kill, to probe whether a block's publisher is alive
+#include <fcntl.h>    // For O_* flags passed to shm_open
+#include <sys/mman.h> // For shm_open and mmap
+#include <sys/stat.h> // For fstat on a block left behind
+#include <unistd.h>   // For ftruncate, close and getpid
+#endif
+
+namespace telemetry {
+
+namespace {
+    // Process-local fallback used before publishing starts or when it fails.
+    Block s_localBlock{};
+
+    Block* s_sharedBlock = nullptr;
+#ifdef _WIN32
+    HANDLE s_mapping = NULL;
+#endif
+
+    void initialize_header(Block* block, std::uint32_t processId) {
+        block->magic = kMagic;
+        block->version = kVersion;
+        block->counterCount = static_cast<std::uint32_t>(Counter::Count);
+        block->processId = processId;
+    }
+
+    // Whether a process is still running. Unknown counts as running, so a live
+    // instance is never taken over.
+    bool process_alive(std::uint32_t processId) {
+#ifdef _WIN32
+        const HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, processId);
+        if (!process) {
+            return GetLastError() != ERROR_INVALID_PARAMETER;
+        }
+        const bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return running;
+#else
+        return kill(static_cast<pid_t>(processId), 0) == 0 || errno != ESRCH;
+#endif
+    }
+
+    // A block whose publisher is gone: it crashed or was killed, and the block was kept
+    // by a reader (Windows) or by /dev/shm (POSIX). Its own id means a reused process id.
+    bool is_stale(const Block& block, std::uint32_t processId) {
+        return block.magic != kMagic || block.processId == 0 || block.processId == processId
+            || !process_alive(block.processId);
+    }
+}
+
+namespace detail {
+    Block* g_block = &s_localBlock;
+}
+
+bool open_publisher() {
+    if (s_sharedBlock) {
+        return true;
+    }
+#ifdef _WIN32
+    const std::uint32_t processId = GetCurrentProcessId();
+    s_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(Block), kMappingName);
+    if (!s_mapping) {
+        return false;
+    }
+    const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+    void* view = MapViewOfFile(s_mapping, FILE_MAP_WRITE, 0, 0, sizeof(Block));
+    // A second instance must not interleave its writes with a live owner's seqlock.
+    if (!view || (existed && !is_stale(*static_cast<const Block*>(view), processId))) {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(s_mapping);
+        s_mapping = NULL;
+        return false;
+    }
+#else
+    const std::uint32_t processId = static_cast<std::uint32_t>(getpid());
+    bool existed = false;
+    int fd = shm_open(kMappingName, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        existed = true;
+        fd = shm_open(kMappingName, O_RDWR, 0);
+    }
+    if (fd < 0) {
+        return false;
+    }
+    // A block cut short by a crash during creation is sized again and taken over.
+    struct stat info;
+    const bool complete = existed && fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(Block));
+    void* view = MAP_FAILED;
+    if (complete || ftruncate(fd, sizeof(Block)) == 0) {
+        view = mmap(nullptr, sizeof(Block), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (view == MAP_FAILED) {
+        if (!existed) shm_unlink(kMappingName);
+        return false;
+    }
+    // A second instance must not interleave its writes with a live owner's seqlock.
+    if (complete && !is_stale(*static_cast<const Block*>(view), processId)) {
+        munmap(view, sizeof(Block));
+        return false;
+    }
+#endif
+    // Construct the block in place, which also clears a dead owner's counters, and carry
+    // over anything counted before publishing started.
+    s_sharedBlock = new (view) Block{};
+    initialize_header(s_sharedBlock, processId);
+    for (std::size_t i = 0; i < kMaxCounters; ++i) {
+        s_sharedBlock->values[i].store(s_localBlock.values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    detail::g_block = s_sharedBlock;
+    return true;
+}
+
+void close_publisher() {
+    if (!s_sharedBlock) {
+        return;
+    }
+    // Keep counting locally so late updates during shutdown stay valid.
+    for (std::size_t i = 0; i < kMaxCounters; ++i) {
+        s_localBlock.values[i].store(s_sharedBlock->values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    detail::g_block = &s_localBlock;
+#ifdef _WIN32
+    UnmapViewOfFile(s_sharedBlock);
+    CloseHandle(s_mapping);
+    s_mapping = NULL;
+#else
+    munmap(s_sharedBlock, sizeof(Block));
+    shm_unlink(kMappingName);
+#endif
+    s_sharedBlock = nullptr;
+}
+
+const Block* attach_reader() {
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, kMappingName);
+    if (!mapping) {
+        return nullptr;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(Block));
+    // The view keeps the mapping alive on its own.
+    CloseHandle(mapping);
+    return static_cast<const Block*>(view);
+#else
+    const int fd = shm_open(kMappingName, O_RDONLY, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* view = mmap(nullptr, sizeof(Block), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return view == MAP_FAILED ? nullptr : static_cast<const Block*>(view);
+#endif
+}
+
+void detach_reader(const Block* block) {
+    if (!block) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(block);
+#else
+    munmap(const_cast<Block*>(block), sizeof(Block));
+#endif
+}
+
+bool read_snapshot(const Block& block, Snapshot& out) {
+    if (block.magic != kMagic || block.version != kVersion) {
+        return false;
+    }
+    // Writers hold a sequence odd only for a few stores, so a bounded retry
+    // loop is plenty; giving up means the writer died mid-update.
+    constexpr int kMaxAttempts = 10000;
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+        std::uint32_t before[kMaxWriters];
+        bool writing = false;
+        for (std::size_t w = 0; w < kMaxWriters; ++w) {
+            before[w] = block.sequences[w].value.load(std::memory_order_acquire);
+            writing |= (before[w] & 1u) != 0;
+        }
+        if (writing) {
+            continue;
+        }
+        for (std::size_t i = 0; i < kMaxCounters; ++i) {
+            out.values[i] = block.values[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        bool stable = true;
+        std::uint64_t updates = 0;
+        for (std::size_t w = 0; w < kMaxWriters; ++w) {
+            stable &= block.sequences[w].value.load(std::memory_order_relaxed) == before[w];
+            updates += before[w] / 2;
+        }
+        if (stable) {
+            out.counterCount = block.counterCount;
+            out.processId = block.processId;
+            out.updates = updates;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace telemetry
@@ -0,0 +1,232 @@
+#pragma once
+
+// Shared-memory health counters that an external monitor can scrape without a
+// --verbose console. The block is updated under seqlocks: each writing thread owns
+// one sequence and the counters assigned to it, bumps its sequence to an odd value,
+// stores the fields and bumps it back to even, so an update is a handful of plain
+// stores with no lock or syscall. Readers retry until every sequence reads the same
+// even value before and after copying.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace telemetry {
+
+constexpr std::uint32_t kMagic = 0x4D544C53; // "SLTM" in little-endian memory order.
+constexpr std::uint32_t kVersion = 2;        // Bump on any layout change.
+
+// Name of the shared block: a named file mapping on Windows, a POSIX shared memory
+// object (visible as /dev/shm/screenlight-telemetry) elsewhere.
+#ifdef _WIN32
+constexpr wchar_t kMappingName[] = L"Local\\ScreenLightTelemetry";
+#else
+constexpr char kMappingName[] = "/screenlight-telemetry";
+#endif
+
+enum class Counter : std::uint32_t {
+    TimerTicks,
+    CursorMoves,
+    Repaints,
+    KeyEvents,
+    GdiHandles,
+    Brightness,
+    LoopStallMaxUs,
+    StallCount,
+    StallLastUs,
+    StallLastMessage,
+    MotionJitterMaxUs,
+    MotionJitterMeanUs,
+    PrivateBytes,
+    WorkingSetBytes,
+    UserHandles,
+    SteadyWorkingSetBytes,
+    ColorTemperatureK,
+    AmbientSamples,
+    AmbientTarget,
+    CpuBudgetPermille,
+    CpuUsagePermille,
+    SystemBusyPercent,
+    GovernedFrameDelayMs,
+    MotionTickRateMilliHz,
+    ThrottleEvents,
+    LoopWakeups,
+    WatchdogWakeups,
+    GammaUploads,
+    Count
+};
+
+// The thread that owns each counter's seqlock. A counter must only be updated from its writer.
+enum class Writer : std::uint32_t {
+    Ui,
+    Watchdog,
+    Motion,
+    Count
+};
+
+// Display names for the reader, indexed by Counter.
+constexpr std::string_view kCounterNames[] = {
+    "timer_ticks",
+    "cursor_moves",
+    "repaints",
+    "key_events",
+    "gdi_handles",
+    "brightness",
+    "loop_stall_max_us",
+    "stall_count",
+    "stall_last_us",
+    "stall_last_message",
+    "motion_jitter_max_us",
+    "motion_jitter_mean_us",
+    "private_bytes",
+    "working_set_bytes",
+    "user_handles",
+    "steady_working_set_bytes",
+    "color_temperature_k",
+    "ambient_samples",
+    "ambient_target",
+    "cpu_budget_permille",
+    "cpu_usage_permille",
+    "system_busy_percent",
+    "governed_frame_delay_ms",
+    "motion_tick_rate_mhz",
+    "throttle_events",
+    "loop_wakeups",
+    "watchdog_wakeups",
+    "gamma_uploads",
+};
+static_assert(std::size(kCounterNames) == static_cast<std::size_t>(Counter::Count));
+
+// Owning writer, indexed by Counter.
+constexpr Writer kCounterWriters[] = {
+    Writer::Motion,
+    Writer::Motion,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Watchdog,
+    Writer::Watchdog,
+    Writer::Watchdog,
+    Writer::Motion,
+    Writer::Motion,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Ui,
+    Writer::Watchdog,
+    Writer::Ui,
+};
+static_assert(std::size(kCounterWriters) == static_cast<std::size_t>(Counter::Count));
+
+// Fixed number of slots so that appending a counter does not move the layout.
+constexpr std::size_t kMaxCounters = 32;
+static_assert(static_cast<std::size_t>(Counter::Count) <= kMaxCounters);
+constexpr std::size_t kMaxWriters = 4;
+static_assert(static_cast<std::size_t>(Writer::Count) <= kMaxWriters);
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Counters must be address-free across processes");
+
+// One writer's sequence, on its own cache line so writers do not contend.
+struct alignas(64) Sequence {
+    std::atomic<std::uint32_t> value; // Odd while the writer is mid-update.
+};
+
+struct alignas(64) Block {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t counterCount;
+    std::uint32_t processId;
+    Sequence sequences[kMaxWriters];
+    std::atomic<std::uint64_t> values[kMaxCounters];
+};
+
+// A consistent copy of the block taken by a reader.
+struct Snapshot {
+    std::uint32_t counterCount = 0;
+    std::uint32_t processId = 0;
+    std::uint64_t updates = 0; // Total completed updates across all writers.
+    std::uint64_t values[kMaxCounters] = {};
+};
+
+namespace detail {
+    // Always valid: points at a process-local block until open_publisher() succeeds,
+    // so the update helpers never need to check whether publishing is enabled.
+    extern Block* g_block;
+
+    inline std::atomic<std::uint64_t>& slot(Counter counter) {
+        return g_block->values[static_cast<std::size_t>(counter)];
+    }
+
+    inline std::atomic<std::uint32_t>& sequence(Counter counter) {
+        return g_block->sequences[static_cast<std::size_t>(kCounterWriters[static_cast<std::size_t>(counter)])].value;
+    }
+}
+
+// Creates the shared block and starts publishing into it. A block left behind by an
+// instance that is no longer running is taken over. Returns false if the block could not
+// be created or a running instance owns it; updates then stay local.
+bool open_publisher();
+void close_publisher();
+
+// Maps an existing block read-only for a monitor. Returns nullptr if none is published.
+const Block* attach_reader();
+void detach_reader(const Block* block);
+
+// Copies the block, retrying while a write is in progress. Returns false if the
+// block is not a compatible telemetry block or the writer never settled.
+bool read_snapshot(const Block& block, Snapshot& out);
+
+// Opens a write section on the counter's writer sequence. Only the owning thread may
+// call this; pair it with end_update() on a counter of the same writer.
+inline std::uint32_t begin_update(Counter counter) {
+    auto& sequence = detail::sequence(counter);
+    const std::uint32_t s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return s;
+}
+
+inline void end_update(Counter counter, std::uint32_t s) {
+    detail::sequence(counter).store(s + 2, std::memory_order_release);
+}
+
+inline void add(Counter counter, std::uint64_t delta = 1) {
+    const std::uint32_t s = begin_update(counter);
+    auto& value = detail::slot(counter);
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    end_update(counter, s);
+}
+
+inline void set(Counter counter, std::uint64_t value) {
+    const std::uint32_t s = begin_update(counter);
+    detail::slot(counter).store(value, std::memory_order_relaxed);
+    end_update(counter, s);
+}
+
+// Reads one counter of this process's block, e.g. one another thread writes. A single
+// counter needs no seqlock retry.
+inline std::uint64_t value(Counter counter) {
+    return detail::slot(counter).load(std::memory_order_relaxed);
+}
+
+// Raises a high-water mark; the common case of no new maximum writes nothing.
+inline void raise(Counter counter, std::uint64_t value) {
+    if (value > detail::slot(counter).load(std::memory_order_relaxed)) {
+        set(counter, value);
+    }
+}
+
+} // namespace telemetry
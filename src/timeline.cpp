@@ -0,0 +1,141 @@
+#include "timeline.h"
+
+#include <algorithm>
+
+namespace timeline {
+
+Scheduler::Scheduler(Timer& timer, std::chrono::milliseconds framePeriod)
+    : m_timer(timer), m_framePeriod(std::max(framePeriod, std::chrono::milliseconds(1))), m_frameOrigin(Clock::now()) {}
+
+Scheduler::~Scheduler() {
+    for (Slot& slot : m_slots) {
+        if (slot.handle) slot.handle.destroy();
+    }
+}
+
+TaskId Scheduler::spawn(Task task) {
+    std::uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+    const auto handle = task.m_handle;
+    task.m_handle = nullptr;
+    handle.promise().slot = slot;
+    m_slots[slot].handle = handle;
+    ++m_liveTasks;
+    const TaskId id = (TaskId{m_slots[slot].generation} << 32) | slot;
+    resume(slot);
+    return id;
+}
+
+void Scheduler::cancel(TaskId id) {
+    const auto slot = static_cast<std::uint32_t>(id);
+    if (slot >= m_slots.size() || m_slots[slot].generation != static_cast<std::uint32_t>(id >> 32) || !m_slots[slot].handle) {
+        return;
+    }
+    release(slot);
+    if (!m_dispatching) {
+        rearm(Clock::now());
+    }
+}
+
+void Scheduler::clear() {
+    for (std::uint32_t slot = 0; slot < m_slots.size(); ++slot) {
+        if (m_slots[slot].handle) release(slot);
+    }
+    m_heap.clear();
+    if (m_armed) {
+        m_timer.disarm();
+        m_armed = false;
+        ++m_disarms;
+    }
+}
+
+std::size_t Scheduler::run_due(Clock::time_point now) {
+    m_dispatching = true;
+    m_dispatchTime = now;
+    std::size_t resumed = 0;
+    // Waits set while dispatching are never at or before now (an already due wait does
+    // not suspend), so this loop only sees the entries that were due on entry.
+    while (!m_heap.empty() && m_heap.front().deadline <= now) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        const Entry entry = m_heap.back();
+        m_heap.pop_back();
+        if (is_stale(entry)) {
+            continue;
+        }
+        resume(entry.slot);
+        ++resumed;
+    }
+    m_dispatching = false;
+    // The platform timer is periodic, so the arming that fired is spent whatever was due:
+    // re-arm it for the next deadline, or disarm it if nothing waits. Left alone after an
+    // early fire, it would keep firing on its old period with no work.
+    m_armedDeadline = Clock::time_point::min();
+    rearm(std::max(now, Clock::now()));
+    return resumed;
+}
+
+Scheduler::Wait Scheduler::next_frame() {
+    const Clock::duration elapsed = now() - m_frameOrigin;
+    return {*this, m_frameOrigin + (elapsed / m_framePeriod + 1) * m_framePeriod};
+}
+
+void Scheduler::wait(std::coroutine_handle<Task::promise_type> handle, Clock::time_point deadline) {
+    const std::uint32_t slot = handle.promise().slot;
+    m_heap.push_back({deadline, m_sequence++, slot, m_slots[slot].generation});
+    std::push_heap(m_heap.begin(), m_heap.end(), later);
+    if (!m_dispatching) {
+        rearm(Clock::now());
+    }
+}
+
+void Scheduler::resume(std::uint32_t slot) {
+    // Copied out: the task may spawn others and grow m_slots while it runs.
+    const auto handle = m_slots[slot].handle;
+    ++m_resumes;
+    handle.resume();
+    if (handle.done()) {
+        release(slot);
+    }
+}
+
+void Scheduler::release(std::uint32_t slot) {
+    m_slots[slot].handle.destroy();
+    m_slots[slot].handle = nullptr;
+    ++m_slots[slot].generation;
+    m_freeSlots.push_back(slot);
+    --m_liveTasks;
+}
+
+// Points the timer at the earliest live deadline. Outside run_due the timer is only
+// touched when that deadline changes.
+void Scheduler::rearm(Clock::time_point now) {
+    while (!m_heap.empty() && is_stale(m_heap.front())) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        m_heap.pop_back();
+    }
+    if (m_heap.empty()) {
+        if (m_armed) {
+            m_timer.disarm();
+            m_armed = false;
+            ++m_disarms;
+        }
+        return;
+    }
+    const Clock::time_point deadline = m_heap.front().deadline;
+    if (m_armed && deadline == m_armedDeadline) {
+        return;
+    }
+    const auto delay = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+    m_timer.arm(std::max(delay, std::chrono::milliseconds(1)));
+    m_armed = true;
+    m_armedDeadline = deadline;
+    ++m_arms;
+}
+
+} // namespace timeline
@@ -0,0 +1,154 @@
+#pragma once
+
+// Periodic and delayed work on the UI thread, written as coroutines that co_await a
+// deadline or the next frame. However many tasks are waiting, the scheduler keeps
+// exactly one platform timer armed, for the earliest deadline, and none while nothing
+// waits; so adding a fade or a periodic check never adds a timer ID.
+//
+// Deadlines set while dispatching are measured from the dispatch time rather than from
+// when the task happens to run, so a task that waits for the same delay in a loop keeps
+// its period instead of drifting by its own run time. Frame waits land on a shared
+// frame grid, so every task waiting for the next frame resumes from the same wakeup.
+//
+// Everything runs on the thread that owns the scheduler; tasks never run concurrently.
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <vector>
+
+namespace timeline {
+
+using Clock = std::chrono::steady_clock;
+
+// The single platform timer (SetTimer on Windows). arm replaces any earlier arming.
+class Timer {
+public:
+    virtual ~Timer() = default;
+    virtual void arm(std::chrono::milliseconds delay) = 0;
+    virtual void disarm() = 0;
+};
+
+// Identifies a spawned task for cancel(). Never 0, and never reused for another task.
+using TaskId = std::uint64_t;
+
+// The return type of a timeline coroutine. It does not start until spawned.
+class Task {
+public:
+    struct promise_type {
+        std::uint32_t slot = 0;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        // Suspends at the end so the scheduler, not the coroutine, frees the frame.
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    Task& operator=(Task&&) = delete;
+    ~Task() {
+        if (m_handle) m_handle.destroy();
+    }
+
+private:
+    friend class Scheduler;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+class Scheduler {
+public:
+    // framePeriod is the spacing of the frame grid next_frame() waits on.
+    explicit Scheduler(Timer& timer, std::chrono::milliseconds framePeriod);
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+    // Destroys waiting tasks without resuming them. The timer is left alone, as the
+    // window owning it may already be gone; call clear() first to disarm it.
+    ~Scheduler();
+
+    // Runs the task until its first co_await and keeps it until it finishes or is cancelled.
+    TaskId spawn(Task task);
+    // Destroys a waiting task without resuming it. Unknown or finished ids are ignored. A
+    // task must not cancel itself; it returns instead.
+    void cancel(TaskId id);
+    // Cancels every task and disarms the timer.
+    void clear();
+
+    // Called when the timer fires. Resumes every task whose deadline is at or before now,
+    // in deadline order, then re-arms the timer for the next deadline or disarms it.
+    // Returns the number of tasks resumed.
+    std::size_t run_due(Clock::time_point now);
+
+    struct Wait {
+        Scheduler& scheduler;
+        Clock::time_point deadline;
+
+        bool await_ready() const noexcept { return deadline <= scheduler.now(); }
+        void await_suspend(std::coroutine_handle<Task::promise_type> handle) { scheduler.wait(handle, deadline); }
+        void await_resume() const noexcept {}
+    };
+
+    Wait at(Clock::time_point deadline) { return {*this, deadline}; }
+    Wait after(Clock::duration delay) { return {*this, now() + delay}; }
+    // The next point on the frame grid strictly after now.
+    Wait next_frame();
+
+    // The deadline the timer is armed for, if it is armed.
+    [[nodiscard]] std::optional<Clock::time_point> armed_deadline() const {
+        return m_armed ? std::optional<Clock::time_point>(m_armedDeadline) : std::nullopt;
+    }
+    [[nodiscard]] std::size_t task_count() const { return m_liveTasks; }
+    [[nodiscard]] std::uint64_t arm_count() const { return m_arms; }
+    [[nodiscard]] std::uint64_t disarm_count() const { return m_disarms; }
+    [[nodiscard]] std::uint64_t resume_count() const { return m_resumes; }
+
+private:
+    struct Slot {
+        std::coroutine_handle<Task::promise_type> handle;
+        std::uint32_t generation = 1; // Bumped whenever the slot is freed.
+    };
+    // One pending wait. Cancelling a task leaves its entry in the heap; the generation
+    // no longer matches, so it is skipped when it reaches the top.
+    struct Entry {
+        Clock::time_point deadline;
+        std::uint64_t sequence; // Keeps equal deadlines in the order they were set.
+        std::uint32_t slot;
+        std::uint32_t generation;
+    };
+    // Orders the heap with the earliest deadline on top.
+    static bool later(const Entry& a, const Entry& b) {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+    }
+
+    // The dispatch time while run_due is resuming tasks, otherwise the clock.
+    [[nodiscard]] Clock::time_point now() const { return m_dispatching ? m_dispatchTime : Clock::now(); }
+    void wait(std::coroutine_handle<Task::promise_type> handle, Clock::time_point deadline);
+    void resume(std::uint32_t slot);
+    void release(std::uint32_t slot);
+    [[nodiscard]] bool is_stale(const Entry& entry) const { return m_slots[entry.slot].generation != entry.generation; }
+    void rearm(Clock::time_point now);
+
+    Timer& m_timer;
+    const Clock::duration m_framePeriod;
+    const Clock::time_point m_frameOrigin;
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_freeSlots;
+    std::vector<Entry> m_heap;
+    std::uint64_t m_sequence = 0;
+    std::size_t m_liveTasks = 0;
+    bool m_dispatching = false;
+    Clock::time_point m_dispatchTime;
+    bool m_armed = false;
+    Clock::time_point m_armedDeadline;
+    std::uint64_t m_arms = 0;
+    std::uint64_t m_disarms = 0;
+    std::uint64_t m_resumes = 0;
+};
+
+} // namespace timeline
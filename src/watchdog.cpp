@@ -0,0 +1,115 @@
+#include "watchdog.h"
+
+#include <algorithm>
+
+#include "telemetry.h"
+
+void StallWatchdog::start(std::chrono::milliseconds threshold, Callback callback) {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_threshold = threshold;
+    m_callback = callback;
+    m_stopRequested = false;
+    m_thread = std::thread(&StallWatchdog::run, this);
+}
+
+void StallWatchdog::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void StallWatchdog::unpark() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_parked.store(false, std::memory_order_seq_cst);
+    }
+    m_wake.notify_one();
+}
+
+void StallWatchdog::run() {
+    using Clock = std::chrono::steady_clock;
+    // A stall in progress has its duration refreshed four times per threshold.
+    const auto refresh = (std::max)(m_threshold / 4, std::chrono::milliseconds(1));
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopRequested) {
+        const auto start = m_dispatchStart.load(std::memory_order_seq_cst);
+        if (start == kIdle && m_currentStart == kIdle) {
+            // Nothing is dispatching: sleep until the loop stamps a dispatch. The stamp is
+            // read again after parking, so one that raced with the park is not missed.
+            m_parked.store(true, std::memory_order_seq_cst);
+            if (m_dispatchStart.load(std::memory_order_seq_cst) == kIdle) {
+                m_wake.wait(lock, [this] { return m_stopRequested || !m_parked.load(std::memory_order_relaxed); });
+            }
+            m_parked.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        // Wake when this dispatch would become a stall, or to refresh the one in progress.
+        // A tracked stall whose dispatch has returned is finished right away.
+        const auto due = m_currentStart == kIdle ? Clock::time_point(Clock::duration(start)) + m_threshold
+            : start == m_currentStart             ? Clock::now() + refresh
+                                                  : Clock::now();
+        if (m_wake.wait_until(lock, due, [this] { return m_stopRequested; })) {
+            break;
+        }
+        // Checks run unlocked so a slow callback never delays stop().
+        lock.unlock();
+        telemetry::add(telemetry::Counter::WatchdogWakeups);
+        check(Clock::now());
+        lock.lock();
+    }
+    // A stall still in progress at shutdown is reported with what was observed.
+    finish_current();
+}
+
+void StallWatchdog::check(std::chrono::steady_clock::time_point now) {
+    const auto start = m_dispatchStart.load(std::memory_order_acquire);
+    if (m_currentStart != kIdle && start != m_currentStart) {
+        finish_current(); // The tracked dispatch has returned.
+    }
+    if (start == kIdle) {
+        return;
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        now - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(start)));
+    if (elapsed < m_threshold) {
+        return;
+    }
+
+    StallRecord& record = m_records[(m_stallCount - (m_currentStart != kIdle ? 1 : 0)) % kCapacity];
+    if (m_currentStart == kIdle) {
+        // A new stall: claim the next ring slot and timestamp it.
+        m_currentStart = start;
+        record.startedAt = std::chrono::time_point_cast<std::chrono::system_clock::duration>(std::chrono::system_clock::now() - elapsed);
+        record.message = m_message.load(std::memory_order_relaxed);
+        ++m_stallCount;
+        record.duration = elapsed;
+        const std::uint32_t s = telemetry::begin_update(telemetry::Counter::StallCount);
+        telemetry::detail::slot(telemetry::Counter::StallCount).store(m_stallCount, std::memory_order_relaxed);
+        telemetry::detail::slot(telemetry::Counter::StallLastMessage).store(record.message, std::memory_order_relaxed);
+        telemetry::detail::slot(telemetry::Counter::StallLastUs).store(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+        telemetry::end_update(telemetry::Counter::StallCount, s);
+        if (m_callback) m_callback(record, false);
+    } else {
+        record.duration = elapsed;
+        telemetry::set(telemetry::Counter::StallLastUs, static_cast<std::uint64_t>(elapsed.count()));
+    }
+}
+
+void StallWatchdog::finish_current() {
+    if (m_currentStart == kIdle) {
+        return;
+    }
+    const StallRecord& record = m_records[(m_stallCount - 1) % kCapacity];
+    m_maxStall = (std::max)(m_maxStall, record.duration);
+    m_currentStart = kIdle;
+    if (m_callback) m_callback(record, true);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+// Detects message-loop stalls from a separate thread. The loop stamps the start of
+// each dispatch (and which message it is) and clears the stamp when the dispatch
+// returns. The watchdog wakes when a stamped dispatch would reach the threshold and,
+// if it is still running, records it into a preallocated ring. An idle loop blocked
+// in GetMessage holds no stamp, so the watchdog sleeps until the next dispatch starts
+// instead of polling, and costs no wakeups while the light is paused or idle.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct StallRecord {
+    std::chrono::system_clock::time_point startedAt; // Wall-clock time the stalled dispatch began.
+    std::chrono::microseconds duration{0};           // Observed so far; final once the stall ends.
+    std::uint32_t message = 0;                       // The message being dispatched.
+};
+
+class StallWatchdog {
+public:
+    // Called on the watchdog thread when a stall is first detected and when it ends.
+    using Callback = void (*)(const StallRecord& record, bool ended);
+
+    static constexpr std::size_t kCapacity = 64;
+
+    StallWatchdog() = default;
+    StallWatchdog(const StallWatchdog&) = delete;
+    StallWatchdog& operator=(const StallWatchdog&) = delete;
+    ~StallWatchdog() { stop(); }
+
+    void start(std::chrono::milliseconds threshold, Callback callback = nullptr);
+    void stop();
+
+    // Heartbeat stamped by the message loop around each dispatch. Only the loop thread calls these.
+    void begin_dispatch(std::uint32_t message, std::chrono::steady_clock::time_point now) {
+        m_message.store(message, std::memory_order_relaxed);
+        // Sequentially consistent with the watchdog's park, so either it sees this stamp
+        // or this sees it parked; the first dispatch after an idle spell wakes it.
+        m_dispatchStart.store(now.time_since_epoch().count(), std::memory_order_seq_cst);
+        if (m_parked.load(std::memory_order_seq_cst)) {
+            unpark();
+        }
+    }
+
+    void end_dispatch() {
+        m_dispatchStart.store(kIdle, std::memory_order_release);
+    }
+
+    // Results; only safe to read once stop() has returned.
+    [[nodiscard]] std::uint64_t stall_count() const { return m_stallCount; }
+    [[nodiscard]] std::chrono::microseconds max_stall() const { return m_maxStall; }
+    // Visits retained records oldest first.
+    template <typename Visitor>
+    void for_each_record(Visitor&& visit) const {
+        const std::size_t retained = m_stallCount < kCapacity ? static_cast<std::size_t>(m_stallCount) : kCapacity;
+        for (std::size_t i = 0; i < retained; ++i) {
+            visit(m_records[(m_stallCount - retained + i) % kCapacity]);
+        }
+    }
+
+private:
+    static constexpr std::chrono::steady_clock::rep kIdle = 0;
+
+    void run();
+    void unpark();
+    void check(std::chrono::steady_clock::time_point now);
+    void finish_current();
+
+    std::atomic<std::chrono::steady_clock::rep> m_dispatchStart{kIdle};
+    std::atomic<std::uint32_t> m_message{0};
+    std::atomic<bool> m_parked{false}; // The watchdog is asleep until the next dispatch.
+
+    std::chrono::milliseconds m_threshold{0};
+    Callback m_callback = nullptr;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopRequested = false;
+
+    // Owned by the watchdog thread while it runs.
+    std::array<StallRecord, kCapacity> m_records{};
+    std::uint64_t m_stallCount = 0;
+    std::chrono::microseconds m_maxStall{0};
+    std::chrono::steady_clock::rep m_currentStart = kIdle; // Dispatch stamp of the stall being tracked.
+};
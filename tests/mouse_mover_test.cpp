@@ -0,0 +1,91 @@
+// Checks that every motion policy keeps the cursor inside its bounds, including a
+// sub-rectangle whose origin is not (0, 0) and a start point outside it, as happens for
+// --monitor and --bounds on any monitor but the primary, and that the nudge policy
+// lets the motion thread sleep between its moves.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "mouse_mover.h"
+
+namespace {
+
+constexpr int kTicks = 5000;
+
+int g_failures = 0;
+
+template <typename Motion, typename Bounds>
+void check_stays_inside(const char* name, const ScreenRect& area, CursorPoint start) {
+    BasicMouseMover<Motion, Bounds> mover(Bounds(area), start);
+    int moves = 0;
+    CursorPoint previous = mover.update();
+    for (int tick = 0; tick < kTicks; ++tick) {
+        const CursorPoint point = tick == 0 ? previous : mover.update();
+        if (point.x < area.left || point.x >= area.right || point.y < area.top || point.y >= area.bottom) {
+            std::fprintf(stderr, "FAIL %s: tick %d at (%d, %d), outside (%d, %d)-(%d, %d)\n", name, tick, point.x, point.y,
+                         area.left, area.top, area.right, area.bottom);
+            ++g_failures;
+            return;
+        }
+        moves += point == previous ? 0 : 1;
+        previous = point;
+    }
+    if (moves == 0) {
+        std::fprintf(stderr, "FAIL %s: never moved\n", name);
+        ++g_failures;
+    }
+}
+
+// Drives the nudge the way the motion thread does: one update per wakeup, then sleeps
+// through the idle ticks. Every wakeup after the first must move the cursor, and there
+// must be two (the nudge and its return) per nudge interval.
+void check_nudge_cadence() {
+    constexpr ScreenRect kArea{0, 0, 1920, 1080};
+    BasicMouseMover<IdleNudgeMotion, PrimaryScreenBounds> mover{PrimaryScreenBounds(kArea)};
+    constexpr unsigned kIntervals = 100;
+    unsigned tick = 0;
+    unsigned wakeups = 0;
+    CursorPoint placed = mover.update();
+    tick += 1 + mover.skip_idle_ticks();
+    while (tick <= kIntervals * IdleNudgeMotion::kNudgeInterval) { // Through the last return.
+        const CursorPoint point = mover.update();
+        ++wakeups;
+        if (point == placed) {
+            std::fprintf(stderr, "FAIL nudge-cadence: wakeup %u at tick %u did not move\n", wakeups, tick);
+            ++g_failures;
+            return;
+        }
+        placed = point;
+        tick += 1 + mover.skip_idle_ticks();
+    }
+    if (wakeups != 2 * kIntervals) {
+        std::fprintf(stderr, "FAIL nudge-cadence: %u wakeups in %u intervals, expected %u\n", wakeups, kIntervals,
+                     2 * kIntervals);
+        ++g_failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    // The second monitor of a side-by-side pair, with the default start on the first.
+    constexpr ScreenRect kSecondMonitor{1920, 0, 3840, 1080};
+    constexpr CursorPoint kDefaultStart{config::kInitialX, config::kInitialY};
+    check_stays_inside<BounceMotion, SubRectBounds>("bounce", kSecondMonitor, kDefaultStart);
+    check_stays_inside<JiggleMotion, SubRectBounds>("jiggle", kSecondMonitor, kDefaultStart);
+    check_stays_inside<OrbitMotion, SubRectBounds>("orbit", kSecondMonitor, kDefaultStart);
+
+    // A monitor left of and above the primary, and a start on its far edge.
+    constexpr ScreenRect kNegativeMonitor{-1280, -200, 0, 824};
+    check_stays_inside<BounceMotion, VirtualDesktopBounds>("bounce-negative", kNegativeMonitor, {-1, 823});
+
+    // An area narrower than one step.
+    check_stays_inside<BounceMotion, SubRectBounds>("bounce-narrow", {500, 500, 501, 900}, kDefaultStart);
+
+    check_nudge_cadence();
+
+    if (g_failures == 0) {
+        std::printf("All mouse mover checks passed.\n");
+    }
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,241 @@
+// Drives an ambient light source for testing --ambient without a sensor. Writes a
+// deterministic lux pattern in real time to a file (or FIFO) or as UDP datagrams to
+// 127.0.0.1, or with --simulate runs the controller and the rate-limited fade offline
+// and reports how many repaints the readings cost against one repaint per reading.
+//
+// Patterns:
+//   steady   300 lux with a little sensor noise
+//   ramp     dusk to daylight: 1 to 1000 lux, exponentially over the run
+//   burst    300 lux, delivered as bursts of 50 readings once a second
+//   flicker  a lamp flickering between 250 and 350 lux on every reading
+//   step     20 lux, then 800 lux from half-way (a light switched on)
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ambient.h"
+#include "config.h"
+#include "file_io.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct Reading {
+    int atMs;
+    double lux;
+};
+
+// A small deterministic generator, so every run of a pattern is identical.
+class Noise {
+public:
+    // Uniform in [-1, 1).
+    double next() {
+        m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<double>(m_state >> 11) / static_cast<double>(1ull << 52) - 1.0;
+    }
+
+private:
+    std::uint64_t m_state = 0x5C4EE11647u;
+};
+
+bool make_pattern(std::string_view name, int seconds, int rate, std::vector<Reading>& out) {
+    Noise noise;
+    const int durationMs = seconds * 1000;
+    const int intervalMs = std::max(1000 / rate, 1);
+    if (name == "burst") {
+        for (int atMs = 0; atMs < durationMs; atMs += 1000) {
+            for (int i = 0; i < 50; ++i) out.push_back({atMs, 300.0 * (1.0 + 0.05 * noise.next())});
+        }
+        return true;
+    }
+    for (int atMs = 0, index = 0; atMs < durationMs; atMs += intervalMs, ++index) {
+        const double progress = static_cast<double>(atMs) / durationMs;
+        double lux;
+        if (name == "steady") lux = 300.0 * (1.0 + 0.02 * noise.next());
+        else if (name == "ramp") lux = std::pow(1000.0, progress) * (1.0 + 0.02 * noise.next());
+        else if (name == "flicker") lux = index % 2 == 0 ? 250.0 : 350.0;
+        else if (name == "step") lux = (progress < 0.5 ? 20.0 : 800.0) * (1.0 + 0.02 * noise.next());
+        else return false;
+        out.push_back({atMs, lux});
+    }
+    return true;
+}
+
+std::string format_reading(double lux) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f", lux);
+    return text;
+}
+
+// Replays the pattern through the controller as the application would: readings are
+// collected per poll, and each target change starts a fade of one quantum per step
+// from wherever the light is.
+int simulate(const std::vector<Reading>& readings, int durationMs) {
+    using namespace std::chrono;
+    constexpr int kStepDelayMs = 1000 * config::kAmbientQuantum / config::kAmbientLevelsPerSecond;
+    ambient::Controller controller;
+    const steady_clock::time_point start = steady_clock::now();
+    std::vector<double> poll;
+    std::size_t next = 0;
+    std::uint64_t polls = 0;
+    std::uint64_t targetChanges = 0;
+    std::uint64_t repaints = 0;
+    int level = config::kInitialGrayLevel; // The light starts where a fresh install does.
+    int target = -1;
+    int nextStepMs = 0;
+    for (int atMs = 0; atMs <= durationMs + 60'000; ++atMs) {
+        if (atMs % config::kAmbientPollMs == 0) {
+            poll.clear();
+            while (next < readings.size() && readings[next].atMs <= atMs) poll.push_back(readings[next++].lux);
+            if (!poll.empty()) {
+                ++polls;
+                if (controller.update(poll, start + milliseconds(atMs))) {
+                    ++targetChanges;
+                    target = controller.target();
+                    nextStepMs = atMs;
+                }
+            }
+        }
+        if (target >= 0 && level != target && atMs >= nextStepMs) {
+            level += std::clamp(target - level, -config::kAmbientQuantum, config::kAmbientQuantum);
+            ++repaints;
+            nextStepMs = atMs + kStepDelayMs;
+        }
+        if (atMs > durationMs && level == target) break;
+    }
+    std::printf("readings=%zu polls=%llu target_changes=%llu repaints=%llu final_level=%d\n", readings.size(),
+                static_cast<unsigned long long>(polls), static_cast<unsigned long long>(targetChanges),
+                static_cast<unsigned long long>(repaints), level);
+    std::printf("repaints per reading: %.4f (one repaint per reading would be %zu)\n",
+                readings.empty() ? 0.0 : static_cast<double>(repaints) / readings.size(), readings.size());
+    return EXIT_SUCCESS;
+}
+
+// Writes readings to the target as their times come up.
+template <typename Send>
+void play(const std::vector<Reading>& readings, Send send) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const Reading& reading : readings) {
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(reading.atMs));
+        send(format_reading(reading.lux));
+    }
+}
+
+int feed_file(const std::string& path, const std::vector<Reading>& readings) {
+    std::FILE* file = file_io::open_file(path, true);
+    if (!file) {
+        std::fprintf(stderr, "Could not write '%s'.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+    play(readings, [file](const std::string& line) {
+        std::fprintf(file, "%s\n", line.c_str());
+        std::fflush(file);
+    });
+    std::fclose(file);
+    return EXIT_SUCCESS;
+}
+
+int feed_udp(int port, const std::vector<Reading>& readings) {
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        std::fprintf(stderr, "Could not start Winsock.\n");
+        return EXIT_FAILURE;
+    }
+    const SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    const bool opened = s != INVALID_SOCKET;
+#else
+    const int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    const bool opened = s >= 0;
+#endif
+    if (!opened) {
+        std::fprintf(stderr, "Could not create a UDP socket.\n");
+        return EXIT_FAILURE;
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    play(readings, [&](const std::string& datagram) {
+        sendto(s, datagram.data(), static_cast<int>(datagram.size()), 0, reinterpret_cast<const sockaddr*>(&address),
+               sizeof(address));
+    });
+#ifdef _WIN32
+    closesocket(s);
+    WSACleanup();
+#else
+    close(s);
+#endif
+    return EXIT_SUCCESS;
+}
+
+int usage() {
+    std::fprintf(stderr, "Usage: ScreenLightAmbientFeeder steady|ramp|burst|flicker|step (--to=file:PATH|--to=udp:PORT|--simulate)\n"
+                         "                                [--seconds=N] [--rate=HZ]\n");
+    return EXIT_FAILURE;
+}
+
+bool parse_positive(std::string_view text, int& value) {
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && ptr == text.data() + text.size() && value > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string_view pattern;
+    std::string_view to;
+    bool simulateOnly = false;
+    int seconds = 30;
+    int rate = 10;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--simulate") {
+            simulateOnly = true;
+        } else if (arg.starts_with("--to=")) {
+            to = arg.substr(5);
+        } else if (arg.starts_with("--seconds=")) {
+            if (!parse_positive(arg.substr(10), seconds)) return usage();
+        } else if (arg.starts_with("--rate=")) {
+            if (!parse_positive(arg.substr(7), rate)) return usage();
+        } else if (pattern.empty() && !arg.starts_with("--")) {
+            pattern = arg;
+        } else {
+            return usage();
+        }
+    }
+    std::vector<Reading> readings;
+    if (pattern.empty() || simulateOnly == !to.empty() || !make_pattern(pattern, seconds, rate, readings)) {
+        return usage();
+    }
+
+    if (simulateOnly) {
+        return simulate(readings, seconds * 1000);
+    }
+    if (to.starts_with("file:") && to.size() > 5) {
+        return feed_file(std::string(to.substr(5)), readings);
+    }
+    int port = 0;
+    if (to.starts_with("udp:") && parse_positive(to.substr(4), port) && port <= 65535) {
+        return feed_udp(port, readings);
+    }
+    return usage();
+}
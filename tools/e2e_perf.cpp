@@ -0,0 +1,390 @@
+// End-to-end performance suite for the real application. Launches ScreenLight.exe
+// (under Wine and Xvfb in the cross build's CTest run), drives it with key presses
+// posted to its window and measures startup time, idle CPU, wakeups per second, peak
+// and steady working set, and shutdown latency. Each result is checked against the
+// maximum in a thresholds file; the exit code is 1 if any result is over its limit and
+// 2 if the application could not be measured at all. --record writes the thresholds
+// file instead: each limit is the measured result plus a fixed margin, so the limits
+// come from a real run on the machine that will check them.
+//
+// Usage:
+//   ScreenLightE2EPerf --exe=PATH (--thresholds=FILE | --record=FILE [--margin=25])
+//                      [--work-dir=DIR] [--idle-seconds=60] [--startup-runs=5]
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "light_core.h"
+#include "telemetry.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+constexpr wchar_t kWindowClass[] = L"ScreenLightWindowClass";
+constexpr auto kWindowTimeout = 30s;
+constexpr auto kKeyInterval = 50ms;
+// Lets the HUD fade and the repaints of the key script finish before the idle window.
+constexpr auto kSettleTime = 2s;
+constexpr DWORD kExitTimeoutMs = 10000;
+
+// Brightness sweeps, colour temperature steps and a motion toggle, leaving motion on
+// as it starts. Escape is left out: it quits.
+constexpr unsigned kKeyScript[] = {
+    core::kKeyDown, core::kKeyDown, core::kKeyDown, core::kKeyDown, core::kKeyDown,
+    core::kKeyUp, core::kKeyUp, core::kKeyUp, core::kKeyUp, core::kKeyUp,
+    core::kKeyLeft, core::kKeyRight,
+    core::kKeyWarmer, core::kKeyWarmer, core::kKeyCooler, core::kKeyCooler,
+    core::kKeyM, core::kKeyM,
+};
+
+// The measured results, in the order they are reported. Each has a maximum.
+enum Metric { StartupMs, IdleCpuPermille, WakeupsPerSecond, PeakWorkingSetKb, SteadyWorkingSetKb, ShutdownMs, MetricCount };
+constexpr std::string_view kMetricNames[] = {
+    "startup_ms",
+    "idle_cpu_permille",
+    "wakeups_per_second",
+    "peak_working_set_kb",
+    "steady_working_set_kb",
+    "shutdown_ms",
+};
+static_assert(std::size(kMetricNames) == MetricCount);
+
+struct Arguments {
+    std::wstring exe;
+    std::wstring thresholds;
+    std::wstring record;
+    int marginPercent = 25;
+    std::wstring workDir = L".";
+    int idleSeconds = 60;
+    int startupRuns = 5;
+};
+
+// CTest passes the build tree's Unix paths under Wine, which maps the Unix root to
+// drive Z:. Windows paths are returned unchanged.
+std::wstring to_windows_path(std::string_view path) {
+    std::wstring wide(path.size(), L'\0');
+    const int length = MultiByteToWideChar(CP_ACP, 0, path.data(), static_cast<int>(path.size()), wide.data(),
+                                           static_cast<int>(wide.size()));
+    wide.resize(static_cast<std::size_t>(std::max(length, 0)));
+    if (!wide.empty() && wide.front() == L'/') {
+        std::replace(wide.begin(), wide.end(), L'/', L'\\');
+        wide.insert(0, L"Z:");
+    }
+    return wide;
+}
+
+bool parse_count(std::string_view text, int& value) {
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && ptr == text.data() + text.size() && value > 0;
+}
+
+bool parse_arguments(int argc, char** argv, Arguments& arguments) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const std::size_t equals = arg.find('=');
+        const std::string_view name = arg.substr(0, equals);
+        const std::string_view value = equals == std::string_view::npos ? std::string_view() : arg.substr(equals + 1);
+        if (value.empty()) return false;
+        if (name == "--exe") arguments.exe = to_windows_path(value);
+        else if (name == "--thresholds") arguments.thresholds = to_windows_path(value);
+        else if (name == "--record") arguments.record = to_windows_path(value);
+        else if (name == "--margin") { if (!parse_count(value, arguments.marginPercent)) return false; }
+        else if (name == "--work-dir") arguments.workDir = to_windows_path(value);
+        else if (name == "--idle-seconds") { if (!parse_count(value, arguments.idleSeconds)) return false; }
+        else if (name == "--startup-runs") { if (!parse_count(value, arguments.startupRuns)) return false; }
+        else return false;
+    }
+    return !arguments.exe.empty() && arguments.thresholds.empty() != arguments.record.empty();
+}
+
+// Reads "name = maximum" lines; # starts a comment. Every metric needs a limit, so a
+// misspelt name fails the run instead of silently going unchecked.
+bool load_thresholds(const std::wstring& path, double (&limits)[MetricCount]) {
+    std::FILE* file = _wfopen(path.c_str(), L"rb");
+    if (!file) {
+        std::fprintf(stderr, "Cannot open the thresholds file.\n");
+        return false;
+    }
+    bool seen[MetricCount] = {};
+    bool ok = true;
+    char buffer[256];
+    int lineNumber = 0;
+    while (ok && std::fgets(buffer, sizeof(buffer), file)) {
+        ++lineNumber;
+        std::string_view line = buffer;
+        line = line.substr(0, line.find('#'));
+        const auto trim = [](std::string_view text) {
+            const std::size_t begin = text.find_first_not_of(" \t\r\n");
+            return begin == std::string_view::npos ? std::string_view() : text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+        };
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        const std::size_t equals = line.find('=');
+        const std::string_view name = trim(line.substr(0, equals));
+        const std::string_view value = equals == std::string_view::npos ? std::string_view() : trim(line.substr(equals + 1));
+        const auto metric = std::find(std::begin(kMetricNames), std::end(kMetricNames), name);
+        double limit = 0.0;
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), limit);
+        if (metric == std::end(kMetricNames) || value.empty() || ec != std::errc() || ptr != value.data() + value.size()) {
+            std::fprintf(stderr, "Thresholds line %d: expected NAME = MAXIMUM with a known name.\n", lineNumber);
+            ok = false;
+            break;
+        }
+        const auto index = static_cast<std::size_t>(metric - std::begin(kMetricNames));
+        limits[index] = limit;
+        seen[index] = true;
+    }
+    std::fclose(file);
+    for (int i = 0; ok && i < MetricCount; ++i) {
+        if (!seen[i]) {
+            std::fprintf(stderr, "Thresholds file has no limit for %s.\n", kMetricNames[i].data());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Writes a thresholds file whose limits are the results plus marginPercent, rounded up.
+bool write_thresholds(const std::wstring& path, const double (&results)[MetricCount], int marginPercent) {
+    std::FILE* file = _wfopen(path.c_str(), L"wb");
+    if (!file) {
+        std::fprintf(stderr, "Cannot create the thresholds file.\n");
+        return false;
+    }
+    std::fprintf(file, "# Limits for the end-to-end performance suite (ScreenLightE2EPerf), recorded with\n"
+                       "# --record: each is the measured result plus %d%%. Record again after changing\n"
+                       "# the machine or the CI image.\n",
+                 marginPercent);
+    for (int i = 0; i < MetricCount; ++i) {
+        std::fprintf(file, "%s = %.0f # measured %.1f\n", kMetricNames[i].data(),
+                     std::ceil(results[i] * (100 + marginPercent) / 100.0), results[i]);
+    }
+    return std::fclose(file) == 0;
+}
+
+class Process {
+public:
+    Process() = default;
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+    ~Process() {
+        if (m_info.hProcess) {
+            // Never leave an instance behind to skew the next test.
+            if (WaitForSingleObject(m_info.hProcess, 0) == WAIT_TIMEOUT) TerminateProcess(m_info.hProcess, 3);
+            CloseHandle(m_info.hProcess);
+            CloseHandle(m_info.hThread);
+        }
+    }
+
+    bool launch(const Arguments& arguments, std::wstring_view extra) {
+        // A fresh state file and no settings file: every run starts from the defaults.
+        const std::wstring state = arguments.workDir + L"\\e2e-perf.state";
+        DeleteFileW(state.c_str());
+        std::wstring commandLine = L"\"" + arguments.exe + L"\" --no-hotkeys --state=\"" + state + L"\" --config=\""
+            + arguments.workDir + L"\\e2e-perf.conf\" --flight-recorder=\"" + arguments.workDir + L"\\e2e-perf.flight\"";
+        commandLine += extra;
+        STARTUPINFOW startup = {};
+        startup.cb = sizeof(startup);
+        return CreateProcessW(arguments.exe.c_str(), commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr,
+                              &startup, &m_info) != 0;
+    }
+
+    // Waits for the process to exit. Returns its exit code, or -1 on timeout.
+    long long wait(DWORD timeoutMs) {
+        DWORD code = 0;
+        if (WaitForSingleObject(m_info.hProcess, timeoutMs) != WAIT_OBJECT_0 || !GetExitCodeProcess(m_info.hProcess, &code)) {
+            return -1;
+        }
+        return code;
+    }
+
+    HANDLE handle() const { return m_info.hProcess; }
+    DWORD id() const { return m_info.dwProcessId; }
+
+private:
+    PROCESS_INFORMATION m_info = {};
+};
+
+struct WindowSearch {
+    DWORD processId;
+    HWND found;
+};
+
+BOOL CALLBACK match_window(HWND hwnd, LPARAM parameter) {
+    auto& search = *reinterpret_cast<WindowSearch*>(parameter);
+    DWORD owner = 0;
+    wchar_t className[64];
+    GetWindowThreadProcessId(hwnd, &owner);
+    if (owner == search.processId && GetClassNameW(hwnd, className, 64) && std::wstring_view(className) == kWindowClass) {
+        search.found = hwnd;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+HWND find_window(DWORD processId) {
+    WindowSearch search{processId, nullptr};
+    EnumWindows(match_window, reinterpret_cast<LPARAM>(&search));
+    return search.found;
+}
+
+std::chrono::microseconds process_cpu(HANDLE process) {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+        return std::chrono::microseconds(0);
+    }
+    const auto ticks = [](const FILETIME& t) { return (static_cast<std::uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+    // FILETIME counts 100 ns units.
+    return std::chrono::microseconds((ticks(kernel) + ticks(user)) / 10);
+}
+
+// Every thread wakeup the application counts: the UI loop, the watchdog and the motion thread.
+bool read_wakeups(DWORD processId, std::uint64_t& wakeups) {
+    const telemetry::Block* block = telemetry::attach_reader();
+    if (!block) {
+        return false;
+    }
+    telemetry::Snapshot snapshot;
+    const bool ok = telemetry::read_snapshot(*block, snapshot) && snapshot.processId == processId
+        && snapshot.counterCount > static_cast<std::uint32_t>(telemetry::Counter::WatchdogWakeups);
+    telemetry::detach_reader(block);
+    if (ok) {
+        wakeups = snapshot.values[static_cast<std::size_t>(telemetry::Counter::LoopWakeups)]
+            + snapshot.values[static_cast<std::size_t>(telemetry::Counter::WatchdogWakeups)]
+            + snapshot.values[static_cast<std::size_t>(telemetry::Counter::TimerTicks)];
+    }
+    return ok;
+}
+
+double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Median wall time of --exit-after-startup, which shows the first frame and quits.
+// One discarded run first warms the file cache (and wineserver under Wine).
+bool measure_startup(const Arguments& arguments, double& result) {
+    std::vector<double> samples;
+    for (int run = 0; run <= arguments.startupRuns; ++run) {
+        Process process;
+        const auto start = Clock::now();
+        if (!process.launch(arguments, L" --exit-after-startup") || process.wait(kExitTimeoutMs) != 0) {
+            std::fprintf(stderr, "Startup run %d did not exit cleanly.\n", run);
+            return false;
+        }
+        if (run > 0) samples.push_back(ms_since(start));
+    }
+    std::sort(samples.begin(), samples.end());
+    result = samples[samples.size() / 2];
+    return true;
+}
+
+// One normal session: key script, idle window, then a clean close.
+bool measure_session(const Arguments& arguments, double (&results)[MetricCount]) {
+    Process process;
+    if (!process.launch(arguments, L"")) {
+        std::fprintf(stderr, "Cannot launch the application.\n");
+        return false;
+    }
+    HWND window = nullptr;
+    for (const auto deadline = Clock::now() + kWindowTimeout; !window && Clock::now() < deadline;) {
+        Sleep(10);
+        window = find_window(process.id());
+    }
+    if (!window) {
+        std::fprintf(stderr, "The application window did not appear.\n");
+        return false;
+    }
+
+    // The same window messages a keyboard produces, without needing focus.
+    for (const unsigned key : kKeyScript) {
+        PostMessageW(window, WM_KEYDOWN, key, 1);
+        PostMessageW(window, WM_KEYUP, key, 0xC0000001);
+        Sleep(static_cast<DWORD>(kKeyInterval.count()));
+    }
+    Sleep(static_cast<DWORD>(std::chrono::milliseconds(kSettleTime).count()));
+
+    std::uint64_t wakeupsBefore = 0;
+    std::uint64_t wakeupsAfter = 0;
+    if (!read_wakeups(process.id(), wakeupsBefore)) {
+        std::fprintf(stderr, "The application publishes no telemetry; is another instance running?\n");
+        return false;
+    }
+    const auto cpuBefore = process_cpu(process.handle());
+    const auto idleStart = Clock::now();
+    Sleep(static_cast<DWORD>(arguments.idleSeconds) * 1000);
+    const auto cpuAfter = process_cpu(process.handle());
+    const double idleMs = ms_since(idleStart);
+    PROCESS_MEMORY_COUNTERS memory = {};
+    memory.cb = sizeof(memory);
+    if (!read_wakeups(process.id(), wakeupsAfter) || !GetProcessMemoryInfo(process.handle(), &memory, sizeof(memory))) {
+        std::fprintf(stderr, "The application could not be sampled after the idle window.\n");
+        return false;
+    }
+    results[IdleCpuPermille] = std::chrono::duration<double, std::micro>(cpuAfter - cpuBefore).count() / idleMs;
+    results[WakeupsPerSecond] = static_cast<double>(wakeupsAfter - wakeupsBefore) * 1000.0 / idleMs;
+    results[PeakWorkingSetKb] = static_cast<double>(memory.PeakWorkingSetSize) / 1024.0;
+    results[SteadyWorkingSetKb] = static_cast<double>(memory.WorkingSetSize) / 1024.0;
+
+    const auto closeStart = Clock::now();
+    PostMessageW(window, WM_CLOSE, 0, 0);
+    const long long exitCode = process.wait(kExitTimeoutMs);
+    results[ShutdownMs] = ms_since(closeStart);
+    if (exitCode != 0) {
+        std::fprintf(stderr, "The application did not exit cleanly after WM_CLOSE (%lld).\n", exitCode);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Arguments arguments;
+    if (!parse_arguments(argc, argv, arguments)) {
+        std::fprintf(stderr, "Usage: ScreenLightE2EPerf --exe=PATH (--thresholds=FILE | --record=FILE [--margin=PERCENT]) "
+                             "[--work-dir=DIR] [--idle-seconds=N] [--startup-runs=N]\n");
+        return 2;
+    }
+    double limits[MetricCount] = {};
+    double results[MetricCount] = {};
+    CreateDirectoryW(arguments.workDir.c_str(), nullptr);
+    const bool recording = !arguments.record.empty();
+    if ((!recording && !load_thresholds(arguments.thresholds, limits)) || !measure_startup(arguments, results[StartupMs])
+        || !measure_session(arguments, results)) {
+        return 2;
+    }
+    if (recording) {
+        for (int i = 0; i < MetricCount; ++i) {
+            std::printf("%-22s %12.1f\n", kMetricNames[i].data(), results[i]);
+        }
+        return write_thresholds(arguments.record, results, arguments.marginPercent) ? EXIT_SUCCESS : 2;
+    }
+
+    int failures = 0;
+    for (int i = 0; i < MetricCount; ++i) {
+        const bool over = results[i] > limits[i];
+        failures += over ? 1 : 0;
+        std::printf("%-22s %12.1f  limit %10.1f  %s\n", kMetricNames[i].data(), results[i], limits[i], over ? "FAIL" : "ok");
+    }
+    if (failures > 0) {
+        std::printf("%d of %d results over their limit.\n", failures, static_cast<int>(MetricCount));
+        return 1;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+// Prints the events in a flight recorder file, oldest first, one per line with its UTC
+// time and payload. Runs on any host, so a file copied off a kiosk can be read on Linux.
+// Exit code 0 on success, 1 on bad arguments and 2 if the file could not be decoded.
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+#include "flight_recorder.h"
+
+namespace {
+
+// Formats ns since the Unix epoch as an ISO 8601 UTC time with microseconds.
+std::string format_utc(std::int64_t unixNs) {
+    const std::time_t seconds = static_cast<std::time_t>(unixNs / 1'000'000'000);
+    std::tm utc = {};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char text[40];
+    const std::size_t length = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(text + length, sizeof(text) - length, ".%06lldZ", static_cast<long long>(unixNs % 1'000'000'000 / 1000));
+    return text;
+}
+
+std::string_view event_name(std::uint16_t event) {
+    return event < static_cast<std::uint16_t>(flight::Event::Count) ? flight::kEventNames[event] : std::string_view("unknown");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    std::size_t tail = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        constexpr std::string_view prefix = "--tail=";
+        if (arg.starts_with(prefix)) {
+            const auto [ptr, ec] = std::from_chars(arg.data() + prefix.size(), arg.data() + arg.size(), tail);
+            if (ec != std::errc() || ptr != arg.data() + arg.size()) {
+                path = nullptr;
+                break;
+            }
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "Usage: ScreenLightFlightDecoder FILE [--tail=N]\n");
+        return 1;
+    }
+
+    flight::Decoded decoded;
+    std::string error;
+    if (!flight::decode_file(path, decoded, error)) {
+        std::fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 2;
+    }
+
+    const std::uint64_t claimed = decoded.header.next.load();
+    std::printf("pid=%u records=%llu kept=%zu overwritten=%llu torn=%llu clock=%s\n", decoded.header.processId,
+                static_cast<unsigned long long>(claimed), decoded.records.size(),
+                static_cast<unsigned long long>(decoded.overwritten), static_cast<unsigned long long>(decoded.torn),
+                decoded.header.clockKind == flight::ClockKind::Tsc ? "tsc" : "steady");
+    if (decoded.nsPerTick <= 0.0) {
+        std::printf("No calibration after startup; times are raw ticks since the recorder opened.\n");
+    }
+
+    const std::size_t skip = tail != 0 && tail < decoded.records.size() ? decoded.records.size() - tail : 0;
+    for (std::size_t i = skip; i < decoded.records.size(); ++i) {
+        const flight::Record& record = decoded.records[i];
+        const std::int64_t unixNs = flight::unix_ns(decoded, record);
+        const std::string when = unixNs != 0
+            ? format_utc(unixNs)
+            : std::string("+").append(std::to_string(record.ticks - decoded.header.opened.ticks));
+        std::printf("%s %-17.*s arg=%u value=%llu\n", when.c_str(), static_cast<int>(event_name(record.event).size()),
+                    event_name(record.event).data(), record.arg, static_cast<unsigned long long>(record.value));
+    }
+    return EXIT_SUCCESS;
+}
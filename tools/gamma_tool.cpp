@@ -0,0 +1,147 @@
+// Drives a display's gamma ramp through the same code as --gamma-ramp. --check shows a
+// few lights, reads each ramp back, times the uploads and checks that the original comes
+// back; under Xvfb with RandR this covers the X11 path without a real display. --level
+// leaves a light on the ramp with its original saved, as a crashed run would, and
+// --restore undoes that as the next run's recovery does.
+//
+// Usage:
+//   ScreenLightGamma --check [--device=ID] [--saved=PATH]
+//   ScreenLightGamma --level=N [--kelvin=K] [--device=ID] [--saved=PATH]
+//   ScreenLightGamma --restore [--saved=PATH]
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "color_temperature.h"
+#include "gamma_ramp.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+core::Light make_light(int grayLevel, int kelvin, int fraction = 0) {
+    const color::Rgb rgb = color::light_color(grayLevel, kelvin);
+    const color::Rgb next = fraction != 0 ? color::light_color(std::min(grayLevel + 1, 255), kelvin) : rgb;
+    return {grayLevel, fraction, kelvin, rgb, next};
+}
+
+bool parse_int(std::string_view text, int& value) {
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && ptr == text.data() + text.size();
+}
+
+int usage() {
+    std::fprintf(stderr, "Usage: ScreenLightGamma (--check | --level=N [--kelvin=K] | --restore) [--device=ID] [--saved=PATH]\n");
+    return 2;
+}
+
+// Shows each light, compares the ramp read back with the expected one, then restores.
+int check(const std::string& deviceId, const std::string& savedPath) {
+    std::string error;
+    const auto probe = gamma_ramp::open_device(deviceId, error);
+    gamma_ramp::Ramp original;
+    if (!probe || !probe->read(original)) {
+        std::fprintf(stderr, "Cannot read the gamma ramp: %s\n", probe ? "read failed" : error.c_str());
+        return 2;
+    }
+    std::printf("device=%s entries=%zu\n", probe->id().c_str(), original.size());
+
+    gamma_ramp::Driver driver;
+    if (!driver.start(gamma_ramp::open_device(probe->id(), error), savedPath, error)) {
+        std::fprintf(stderr, "Cannot take over the ramp: %s\n", error.c_str());
+        return 2;
+    }
+    const core::Light lights[] = {
+        make_light(255, config::kNeutralKelvin),
+        make_light(128, config::kNeutralKelvin),
+        make_light(200, 2700),
+        make_light(96, 9000, 8),
+    };
+    int failures = 0;
+    for (const core::Light& light : lights) {
+        const auto start = Clock::now();
+        const bool shown = driver.show(light);
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        gamma_ramp::Ramp expected;
+        gamma_ramp::Ramp actual;
+        gamma_ramp::scale(original, light, expected);
+        const bool matches = shown && probe->read(actual) && actual == expected;
+        // A refusal is not a failure: the application paints those lights instead.
+        failures += shown && !matches ? 1 : 0;
+        std::printf("gray=%d fraction=%d kelvin=%d upload_us=%.0f %s\n", light.grayLevel, light.fraction, light.kelvin, us,
+                    !shown ? "refused" : matches ? "ok" : "MISMATCH");
+    }
+    driver.restore();
+    gamma_ramp::Ramp after;
+    const bool restored = probe->read(after) && after == original;
+    std::string savedId;
+    gamma_ramp::Ramp saved;
+    const bool savedRemoved = !gamma_ramp::load_original(savedPath, savedId, saved);
+    std::printf("restored=%s saved_file_removed=%s uploads=%llu\n", restored ? "yes" : "NO", savedRemoved ? "yes" : "NO",
+                static_cast<unsigned long long>(driver.upload_count()));
+    return failures == 0 && restored && savedRemoved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    enum class Mode { None, Check, Level, Restore } mode = Mode::None;
+    std::string deviceId;
+    std::string savedPath = "ScreenLight.gamma";
+    int level = 0;
+    int kelvin = config::kNeutralKelvin;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        bool ok = true;
+        if (arg == "--check") mode = Mode::Check;
+        else if (arg == "--restore") mode = Mode::Restore;
+        else if (arg.starts_with("--level=")) { mode = Mode::Level; ok = parse_int(arg.substr(8), level) && level >= 0 && level <= 255; }
+        else if (arg.starts_with("--kelvin=")) ok = parse_int(arg.substr(9), kelvin) && kelvin >= config::kMinKelvin && kelvin <= config::kMaxKelvin;
+        else if (arg.starts_with("--device=")) deviceId = arg.substr(9);
+        else if (arg.starts_with("--saved=")) savedPath = arg.substr(8);
+        else ok = false;
+        if (!ok) return usage();
+    }
+
+    std::string error;
+    switch (mode) {
+    case Mode::Check:
+        return check(deviceId, savedPath);
+    case Mode::Level: {
+        gamma_ramp::Driver driver;
+        if (!driver.start(gamma_ramp::open_device(deviceId, error), savedPath, error)) {
+            std::fprintf(stderr, "Cannot take over the ramp: %s\n", error.c_str());
+            return 2;
+        }
+        if (!driver.show(make_light(level, kelvin))) {
+            std::fprintf(stderr, "The display refused the ramp.\n");
+            return EXIT_FAILURE;
+        }
+        // Leave the light in place, as a run that never exits cleanly would.
+        std::printf("Showing gray=%d kelvin=%d; the original is saved in %s.\n", level, kelvin, savedPath.c_str());
+        std::fflush(stdout);
+        std::_Exit(EXIT_SUCCESS);
+    }
+    case Mode::Restore:
+        switch (gamma_ramp::recover(savedPath, error)) {
+        case gamma_ramp::RecoverResult::Nothing:
+            std::printf("No saved ramp in %s.\n", savedPath.c_str());
+            return EXIT_SUCCESS;
+        case gamma_ramp::RecoverResult::Restored:
+            std::printf("Restored the saved ramp.\n");
+            return EXIT_SUCCESS;
+        case gamma_ramp::RecoverResult::Failed:
+            std::fprintf(stderr, "Could not restore: %s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+        break;
+    case Mode::None:
+        break;
+    }
+    return usage();
+}
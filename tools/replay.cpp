@@ -0,0 +1,179 @@
+// Replays an input recording through the core and the headless backend, then prints
+// the final state, repaint counts, footprint and per-message cost. By default it runs
+// as fast as possible, which makes recordings usable as throughput benchmarks and as a
+// training workload; --realtime honours the recorded timing instead.
+//
+// A recorded WM_PAINT paints only if the core invalidated the surface since the last
+// paint, so repaints= counts the paints the core's changes cost. Paint messages beyond
+// those are paints the core did not cause, and unpainted=yes flags a change that no
+// later paint message showed.
+//
+// Motion ticks are not part of the message stream (they run on their own thread in
+// the application), so they are synthesized from the recorded timing and frame delay
+// whenever motion is enabled.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "footprint.h"
+#include "headless_backend.h"
+#include "input_recording.h"
+#include "light_core.h"
+#include "mouse_mover.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Synthetic id for motion ticks in the cost table; above every real message.
+constexpr std::uint32_t kMotionTick = 0x10000;
+
+struct Cost {
+    std::uint64_t count = 0;
+    std::chrono::nanoseconds total{0};
+};
+
+const char* message_name(std::uint32_t message) {
+    switch (message) {
+        case core::kMessagePaint: return "WM_PAINT";
+        case core::kMessageKeyDown: return "WM_KEYDOWN";
+        case core::kMessageHotKey: return "WM_HOTKEY";
+        case kMotionTick: return "motion tick";
+        default: return "(not modeled)";
+    }
+}
+
+int usage() {
+    std::fprintf(stderr, "Usage: ScreenLightReplay <recording> [--realtime]\n");
+    return EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path;
+    bool realtime = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--realtime") {
+            realtime = true;
+        } else if (path.empty() && !arg.starts_with("--")) {
+            path = arg;
+        } else {
+            return usage();
+        }
+    }
+    if (path.empty()) {
+        return usage();
+    }
+
+    recording::Reader reader;
+    recording::FileHeader header;
+    if (!reader.open(path, header)) {
+        std::fprintf(stderr, "Could not open recording '%s'.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    const int width = static_cast<int>(header.surfaceWidth);
+    const int height = static_cast<int>(header.surfaceHeight);
+    const int kelvin = header.kelvin != 0 ? color::clamp_kelvin(header.kelvin) : config::kNeutralKelvin;
+    HeadlessBackend backend(width, height, header.edgeLight != 0, header.grayLevel, header.edgeBandWidth, kelvin);
+    backend.set_motion_enabled(header.motionEnabled != 0);
+    core::LightCore light(backend);
+    core::State initial;
+    initial.grayLevel = header.grayLevel;
+    initial.kelvin = kelvin;
+    initial.motionEnabled = header.motionEnabled != 0;
+    initial.edgeLight = header.edgeLight != 0;
+    initial.edgeBandWidth = header.edgeBandWidth;
+    initial.surfaceWidth = width;
+    initial.surfaceHeight = height;
+    light.configure(initial);
+    MouseMover mover(PrimaryScreenBounds(width, height));
+
+    const auto period = std::chrono::microseconds(std::chrono::milliseconds(header.frameDelayMs));
+    std::map<std::uint32_t, Cost> costs;
+    std::uint64_t events = 0;
+    std::chrono::microseconds timeline{0};
+    std::chrono::microseconds nextTick = period;
+    const auto replayStart = Clock::now();
+
+    recording::Event event;
+    while (!backend.quit_requested() && reader.next(event)) {
+        timeline += std::chrono::microseconds(event.deltaUs);
+
+        // Motion ticks that fell due before this message.
+        if (backend.motion_enabled() && period.count() > 0) {
+            Cost& tickCost = costs[kMotionTick];
+            while (nextTick <= timeline) {
+                const auto start = Clock::now();
+                backend.move_cursor(mover.update());
+                tickCost.total += Clock::now() - start;
+                ++tickCost.count;
+                nextTick += period;
+            }
+        } else {
+            nextTick = timeline + period;
+        }
+
+        if (realtime) {
+            std::this_thread::sleep_until(replayStart + timeline);
+        }
+
+        const auto start = Clock::now();
+        if (event.message == core::kMessageKeyDown) {
+            light.handle_key(event.wParam, event.modifiers);
+        } else if (event.message == core::kMessageHotKey) {
+            light.handle_hotkey(event.wParam);
+        } else if (event.message == core::kMessagePaint && backend.is_invalid()) {
+            backend.paint();
+        }
+        Cost& cost = costs[event.message];
+        cost.total += Clock::now() - start;
+        ++cost.count;
+        ++events;
+    }
+
+    const auto replayTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - replayStart);
+    const core::State& state = light.state();
+
+    std::printf("events=%llu recorded_ms=%lld replay_ms=%.3f speedup=%.1fx\n",
+                static_cast<unsigned long long>(events),
+                static_cast<long long>(timeline.count() / 1000),
+                replayTime.count() / 1000.0,
+                replayTime.count() > 0 ? static_cast<double>(timeline.count()) / replayTime.count() : 0.0);
+    std::printf("final gray_level=%d kelvin=%d motion=%s edge_band=%d quit=%s\n",
+                state.grayLevel, state.kelvin, state.motionEnabled ? "on" : "off", state.edgeBandWidth,
+                state.quitRequested ? "yes" : "no");
+    const auto paints = costs.find(core::kMessagePaint);
+    std::printf("invalidations=%llu repaints=%llu paint_messages=%llu unpainted=%s\n",
+                static_cast<unsigned long long>(backend.invalidations()),
+                static_cast<unsigned long long>(backend.repaints()),
+                static_cast<unsigned long long>(paints != costs.end() ? paints->second.count : 0),
+                backend.is_invalid() ? "yes" : "no");
+    std::printf("cursor_moves=%llu region_updates=%llu\n",
+                static_cast<unsigned long long>(backend.cursor_moves()),
+                static_cast<unsigned long long>(backend.region_updates()));
+    // Footprint after the run, so regression runs can track the headless working set too.
+    const footprint::Sample sample = footprint::take_sample();
+    std::printf("working_set_kb=%llu private_kb=%llu\n",
+                static_cast<unsigned long long>(sample.workingSetBytes / 1024),
+                static_cast<unsigned long long>(sample.privateBytes / 1024));
+    std::printf("%-8s %-16s %10s %12s %10s\n", "message", "name", "count", "total_us", "mean_ns");
+    for (const auto& [message, cost] : costs) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "0x%04X", message);
+        std::printf("%-8s %-16s %10llu %12.1f %10.0f\n",
+                    id, message_name(message),
+                    static_cast<unsigned long long>(cost.count),
+                    cost.total.count() / 1000.0,
+                    cost.count ? static_cast<double>(cost.total.count()) / cost.count : 0.0);
+    }
+    return EXIT_SUCCESS;
+}
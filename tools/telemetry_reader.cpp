@@ -0,0 +1,35 @@
+// Prints a consistent snapshot of the telemetry block published by a running
+// ScreenLight instance. Exit code 0 on success, 1 if nothing is published and
+// 2 if the block could not be read consistently.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "telemetry.h"
+
+int main() {
+    const telemetry::Block* block = telemetry::attach_reader();
+    if (!block) {
+        std::fprintf(stderr, "No ScreenLight telemetry block is published.\n");
+        return 1;
+    }
+
+    telemetry::Snapshot snapshot;
+    const bool ok = telemetry::read_snapshot(*block, snapshot);
+    telemetry::detach_reader(block);
+    if (!ok) {
+        std::fprintf(stderr, "Telemetry block is incompatible or was not stable.\n");
+        return 2;
+    }
+
+    std::printf("pid=%u updates=%llu\n", snapshot.processId, static_cast<unsigned long long>(snapshot.updates));
+    // Only print counters this reader knows a name for; newer writers may publish more.
+    const std::size_t known = static_cast<std::size_t>(telemetry::Counter::Count);
+    const std::size_t count = snapshot.counterCount < known ? snapshot.counterCount : known;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::printf("%.*s=%llu\n",
+                    static_cast<int>(telemetry::kCounterNames[i].size()), telemetry::kCounterNames[i].data(),
+                    static_cast<unsigned long long>(snapshot.values[i]));
+    }
+    return EXIT_SUCCESS;
+}
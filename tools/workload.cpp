@@ -0,0 +1,130 @@
+// Writes the canonical training and benchmark workload as an input recording:
+// startup paint, coarse and fine brightness sweeps, system-wide hotkey steps, colour
+// temperature steps, motion toggles with motion ticks in between and, with --edge,
+// band width sweeps in edge-light mode. The output is deterministic so profiles and
+// benchmark numbers are comparable between builds.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "config.h"
+#include "input_recording.h"
+#include "light_core.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+class Script {
+public:
+    explicit Script(recording::Recorder& recorder) : m_recorder(recorder), m_now(std::chrono::steady_clock::now()) {}
+
+    void paint(std::chrono::milliseconds after = 0ms) { emit(core::kMessagePaint, 0, 0, after); }
+
+    // A key press followed by a WM_PAINT. The replay only paints if the key changed
+    // something, so keys that change nothing (Up at full brightness) cost no repaint.
+    void key(unsigned key, unsigned modifiers, std::chrono::milliseconds after) {
+        emit(core::kMessageKeyDown, key, modifiers, after);
+        paint(2ms);
+    }
+
+    void repeat(int count, unsigned key, unsigned modifiers, std::chrono::milliseconds interval) {
+        for (int i = 0; i < count; ++i) this->key(key, modifiers, interval);
+    }
+
+    // The hotkey standing for key, pressed while another application has focus.
+    void hotkey(unsigned key, unsigned modifiers, std::chrono::milliseconds after) {
+        for (unsigned id = 0; id < std::size(core::kHotKeys); ++id) {
+            if (core::kHotKeys[id].key == key && core::kHotKeys[id].modifiers == modifiers) {
+                emit(core::kMessageHotKey, id, 0, after);
+                paint(2ms);
+                return;
+            }
+        }
+    }
+
+private:
+    void emit(std::uint32_t message, unsigned wParam, unsigned modifiers, std::chrono::milliseconds after) {
+        m_now += after;
+        m_recorder.record(message, wParam, static_cast<std::uint16_t>(modifiers), m_now);
+    }
+
+    recording::Recorder& m_recorder;
+    std::chrono::steady_clock::time_point m_now;
+};
+
+int usage() {
+    std::fprintf(stderr, "Usage: ScreenLightWorkload <output.slrec> [--edge] [--rounds=N]\n");
+    return EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path;
+    bool edge = false;
+    int rounds = 5;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--edge") {
+            edge = true;
+        } else if (arg.starts_with("--rounds=")) {
+            rounds = std::atoi(argv[i] + 9);
+            if (rounds <= 0) return usage();
+        } else if (path.empty() && !arg.starts_with("--")) {
+            path = arg;
+        } else {
+            return usage();
+        }
+    }
+    if (path.empty()) {
+        return usage();
+    }
+
+    recording::FileHeader header;
+    header.frameDelayMs = config::kFrameDelayMs;
+    header.surfaceWidth = 1920;
+    header.surfaceHeight = 1080;
+    header.grayLevel = config::kInitialGrayLevel;
+    header.edgeBandWidth = config::kEdgeBandWidth;
+    header.edgeLight = edge ? 1 : 0;
+    header.motionEnabled = edge ? 0 : 1;
+
+    recording::Recorder recorder;
+    if (!recorder.open(path, header)) {
+        std::fprintf(stderr, "Could not write '%s'.\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    Script script(recorder);
+    script.paint(); // First frame at startup.
+    for (int round = 0; round < rounds; ++round) {
+        // Coarse sweep down and back up, as when a user holds the arrow keys.
+        script.repeat(26, core::kKeyDown, 0, 33ms);
+        script.repeat(26, core::kKeyUp, 0, 33ms);
+        // Fine adjustment with Shift held.
+        script.repeat(20, core::kKeyDown, core::kModifierShift, 50ms);
+        script.repeat(20, core::kKeyUp, core::kModifierShift, 50ms);
+        // A few steps from another application through the hotkeys.
+        for (int i = 0; i < 3; ++i) script.hotkey(core::kKeyDown, 0, 250ms);
+        for (int i = 0; i < 3; ++i) script.hotkey(core::kKeyUp, 0, 250ms);
+        // Warmer for a video call and back to neutral, through the colour temperature keys.
+        script.repeat(4, core::kKeyWarmer, 0, 120ms);
+        script.repeat(4, core::kKeyCooler, 0, 120ms);
+        // Motion toggled off and on, with idle time for motion ticks.
+        script.key(core::kKeyM, 0, 500ms);
+        script.key(core::kKeyM, 0, 500ms);
+        if (edge) {
+            script.repeat(8, core::kKeyRight, 0, 40ms);
+            script.repeat(8, core::kKeyLeft, 0, 40ms);
+            script.repeat(10, core::kKeyRight, core::kModifierShift, 40ms);
+            script.repeat(10, core::kKeyLeft, core::kModifierShift, 40ms);
+        }
+    }
+    script.key(core::kKeyEscape, 0, 1000ms);
+    return EXIT_SUCCESS;
+}